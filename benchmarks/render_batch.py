@@ -0,0 +1,51 @@
+import timeit
+
+import zengl
+
+ctx = zengl.context(zengl.loader(headless=True))
+image = ctx.image((64, 64), 'rgba8unorm')
+
+pipeline = ctx.pipeline(
+    vertex_shader='''
+        #version 330
+
+        vec2 positions[3] = vec2[](
+            vec2(0.0, 0.7),
+            vec2(-0.85, -0.8),
+            vec2(0.85, -0.8)
+        );
+
+        void main() {
+            gl_Position = vec4(positions[gl_VertexID], 0.0, 1.0);
+        }
+    ''',
+    fragment_shader='''
+        #version 330
+
+        layout (location = 0) out vec4 out_color;
+
+        void main() {
+            out_color = vec4(1.0, 0.0, 0.0, 1.0);
+        }
+    ''',
+    framebuffer=[image],
+    vertex_count=3,
+)
+
+pipelines = [pipeline] * 4000
+batch = tuple(pipelines)
+
+
+def python_loop():
+    for pipeline in pipelines:
+        pipeline.render()
+
+
+def native_loop():
+    ctx.render(batch)
+
+
+for name, fn in [('python loop', python_loop), ('Context.render', native_loop)]:
+    fn()
+    elapsed = min(timeit.repeat(fn, number=10, repeat=5)) / 10
+    print('%-16s %8.3f ms / %d draws' % (name, elapsed * 1000.0, len(batch)))
@@ -116,6 +116,7 @@ process2 = (
 )
 
 frame = 0
+pending = None
 
 while True:
     in_bytes = process1.stdout.read(width * height * 3)
@@ -136,8 +137,14 @@ while True:
     cube.render()
     image.blit(output)
 
-    out_frame = np.frombuffer(output.read(), 'u1').reshape(width, height, 4)[:, :, :3]
+    if pending is not None:
+        out_frame = np.frombuffer(pending.result(), 'u1').reshape(width, height, 4)[:, :, :3]
+        process2.stdin.write(out_frame.tobytes())
 
+    pending = output.read_async()
+
+if pending is not None:
+    out_frame = np.frombuffer(pending.result(), 'u1').reshape(width, height, 4)[:, :, :3]
     process2.stdin.write(out_frame.tobytes())
 
 process2.stdin.close()
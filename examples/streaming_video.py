@@ -15,7 +15,7 @@ image = ctx.image(window.size, 'rgba8unorm')
 
 @window.render
 def render():
-    image.write(zengl.rgba(next(it), 'rgb'))
+    image.write(zengl.rgba(next(it), 'rgb'), async_=True)
     image.blit()
 
 
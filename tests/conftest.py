@@ -3,5 +3,10 @@ import zengl
 
 
 @pytest.fixture
-def ctx():
-    return zengl.context(zengl.loader(headless=True))
+def loader():
+    return zengl.loader(headless=True)
+
+
+@pytest.fixture
+def ctx(loader):
+    return zengl.context(loader)
@@ -0,0 +1,89 @@
+import numpy as np
+import pytest
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    layout (location = 0) in vec2 in_vertex;
+
+    void main() {
+        gl_Position = vec4(in_vertex, 0.0, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = vec4(1.0, 1.0, 1.0, 1.0);
+    }
+'''
+
+
+def test_buffer_pool(ctx: zengl.Context):
+    pool = ctx.buffer_pool(256)
+    a = pool.alloc(10)
+    b = pool.alloc(16, alignment=64)
+    assert (a.offset, a.size) == (0, 10)
+    assert b.offset == 64
+    assert pool.used == 26
+
+    c = pool.alloc(20)
+    assert c.offset == 12
+    pool.free(a)
+    pool.free(c)
+    with pytest.raises(ValueError):
+        pool.free(c)
+
+    d = pool.alloc(64)
+    assert d.offset == 0
+    with pytest.raises(MemoryError):
+        pool.alloc(256)
+    pool.free(b)
+    pool.free(d)
+    assert pool.alloc(256).offset == 0
+
+
+def test_buffer_pool_release(ctx: zengl.Context):
+    memory = ctx.memory()['buffers']
+    pool = ctx.buffer_pool(1024)
+    assert ctx.memory()['buffers'] == memory + 1024
+    ctx.release(pool)
+    ctx.release(pool)
+    assert ctx.memory()['buffers'] == memory
+
+
+def test_base_vertex(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    pool = ctx.buffer_pool(1024)
+    indices = pool.alloc(12)
+    vertices = pool.alloc(64, alignment=8)
+    pool.buffer.write(np.array([0, 1, 2], 'i4'), offset=indices.offset)
+    triangles = np.array([[-1.0, -1.0, 0.0, -1.0, -1.0, 0.0], [0.0, 0.0, 1.0, 0.0, 0.0, 1.0]], 'f4')
+    pool.buffer.write(triangles, offset=vertices.offset)
+
+    pipeline = ctx.pipeline(
+        vertex_shader=vertex_shader,
+        fragment_shader=fragment_shader,
+        framebuffer=[img],
+        vertex_buffers=zengl.bind(pool.buffer, '2f', 0),
+        index_buffer=pool.buffer,
+        first_vertex=indices.offset // 4,
+        base_vertex=vertices.offset // 8 + 3,
+        vertex_count=3,
+    )
+
+    def pixels():
+        data = np.frombuffer(img.read(), 'u1').reshape(64, 64, 4)
+        return [data[8, 8, 0] == 255, data[40, 40, 0] == 255]
+
+    img.clear()
+    pipeline.render()
+    assert pixels() == [False, True]
+
+    img.clear()
+    pipeline.render_ranges(np.array([[0, 3, 1, vertices.offset // 8]], 'i4'), base_vertex=True)
+    assert pixels() == [True, False]
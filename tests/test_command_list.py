@@ -0,0 +1,81 @@
+import numpy as np
+import pytest
+import zengl
+
+from utils import glsl
+
+
+def test_command_list(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    copy = ctx.image((64, 64), 'rgba8unorm')
+    triangle = ctx.pipeline(
+        vertex_shader=glsl('triangle.vert'),
+        fragment_shader=glsl('triangle.frag'),
+        framebuffer=[img],
+        vertex_count=3,
+    )
+
+    cmds = ctx.command_list()
+    cmds.clear(img)
+    cmds.render(triangle)
+    cmds.blit(img, copy)
+    assert cmds.count == 3
+
+    ctx.execute(cmds)
+    pixels = np.frombuffer(copy.read(), 'u1').reshape(64, 64, 4)
+    assert pixels[32, 32].tolist() == [255, 0, 0, 255]
+    assert pixels[0, 0].tolist() == [0, 0, 0, 0]
+
+
+def test_command_list_write(ctx: zengl.Context):
+    buf = ctx.buffer(size=16)
+    data = bytearray(16)
+    cmds = ctx.command_list()
+    cmds.write(buf, data)
+
+    data[:] = b'0123456789abcdef'
+    ctx.execute(cmds)
+    assert buf.map().tobytes() == b'0123456789abcdef'
+    buf.unmap()
+
+    with pytest.raises(ValueError):
+        cmds.write(buf, data, offset=4)
+
+
+def test_command_list_viewport(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    triangle = ctx.pipeline(
+        vertex_shader=glsl('triangle.vert'),
+        fragment_shader=glsl('triangle.frag'),
+        framebuffer=[img],
+        vertex_count=3,
+    )
+
+    cmds = ctx.command_list()
+    cmds.clear(img)
+    cmds.viewport(triangle, (0, 0, 32, 32))
+    cmds.render(triangle)
+    ctx.execute(cmds)
+    assert triangle.viewport == (0, 0, 64, 64)
+
+    pixels = np.frombuffer(img.read(), 'u1').reshape(64, 64, 4)
+    assert pixels[16, 16].tolist() == [255, 0, 0, 255]
+    assert pixels[32, 32].tolist() == [0, 0, 0, 0]
+
+
+def test_command_list_released_pipeline(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    triangle = ctx.pipeline(
+        vertex_shader=glsl('triangle.vert'),
+        fragment_shader=glsl('triangle.frag'),
+        framebuffer=[img],
+        vertex_count=3,
+    )
+
+    cmds = ctx.command_list()
+    cmds.render(triangle)
+    ctx.release(triangle)
+    ctx.release(triangle)
+
+    with pytest.raises(RuntimeError):
+        ctx.execute(cmds)
@@ -0,0 +1,99 @@
+import numpy as np
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    vec2 positions[3] = vec2[](
+        vec2(-1.0, -1.0),
+        vec2(3.0, -1.0),
+        vec2(-1.0, 3.0)
+    );
+
+    void main() {
+        gl_Position = vec4(positions[gl_VertexID], 0.0, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    uniform sampler2D Texture1;
+    uniform sampler2D Texture2;
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = texture(Texture1, vec2(0.5, 0.5)) + texture(Texture2, vec2(0.5, 0.5));
+    }
+'''
+
+
+def solid(ctx, color):
+    return ctx.image((4, 4), 'rgba8unorm', bytes(color) * 16)
+
+
+def make_pipeline(ctx, img, texture1, texture2):
+    return ctx.pipeline(
+        vertex_shader=vertex_shader,
+        fragment_shader=fragment_shader,
+        layout=[
+            {'name': 'Texture1', 'binding': 0},
+            {'name': 'Texture2', 'binding': 1},
+        ],
+        resources=[
+            {'type': 'sampler', 'binding': 0, 'image': texture1},
+            {'type': 'sampler', 'binding': 1, 'image': texture2},
+        ],
+        framebuffer=[img],
+        vertex_count=3,
+    )
+
+
+def pixel(img):
+    return np.frombuffer(img.read((1, 1)), 'u1').tolist()
+
+
+def test_similar_descriptor_sets(ctx: zengl.Context):
+    img = ctx.image((4, 4), 'rgba8unorm')
+    red = solid(ctx, [255, 0, 0, 0])
+    green = solid(ctx, [0, 255, 0, 0])
+    blue = solid(ctx, [0, 0, 255, 0])
+    red_green = make_pipeline(ctx, img, red, green)
+    red_blue = make_pipeline(ctx, img, red, blue)
+
+    for _ in range(2):
+        red_green.render()
+        assert pixel(img) == [255, 255, 0, 0]
+        red_blue.render()
+        assert pixel(img) == [255, 0, 255, 0]
+
+
+def test_image_write_between_renders(ctx: zengl.Context):
+    img = ctx.image((4, 4), 'rgba8unorm')
+    red = solid(ctx, [255, 0, 0, 0])
+    green = solid(ctx, [0, 255, 0, 0])
+    pipeline = make_pipeline(ctx, img, red, green)
+
+    pipeline.render()
+    assert pixel(img) == [255, 255, 0, 0]
+    green.write(bytes([0, 0, 255, 0]) * 16)
+    solid(ctx, [0, 0, 0, 255])
+    pipeline.render()
+    assert pixel(img) == [255, 0, 255, 0]
+
+
+def test_write_after_sampler_render(ctx: zengl.Context):
+    img = ctx.image((4, 4), 'rgba8unorm')
+    red = solid(ctx, [255, 0, 0, 0])
+    green = solid(ctx, [0, 255, 0, 0])
+    target = solid(ctx, [0, 0, 0, 0])
+    pipeline = make_pipeline(ctx, img, red, green)
+
+    target.write(bytes([0, 0, 255, 255]) * 16)
+    pipeline.render()
+    target.write(bytes([0, 0, 128, 255]) * 16)
+
+    assert red.read() == bytes([255, 0, 0, 0]) * 16
+    assert green.read() == bytes([0, 255, 0, 0]) * 16
+    assert target.read() == bytes([0, 0, 128, 255]) * 16
@@ -0,0 +1,44 @@
+import time
+
+import pytest
+import zengl
+
+
+def test_fence(ctx: zengl.Context):
+    buf = ctx.buffer(size=1024)
+    buf.write(bytes(1024))
+    fence = ctx.fence()
+    fence.wait()
+    assert fence.client_wait(1.0)
+    assert fence.signaled
+    assert fence.client_wait(0.0)
+
+
+def test_fence_poll(ctx: zengl.Context):
+    fence = ctx.fence()
+    deadline = time.time() + 5.0
+    while not fence.signaled and time.time() < deadline:
+        time.sleep(0.001)
+    assert fence.signaled
+    assert fence.client_wait(0.0) is True
+
+
+def test_fence_blocking_wait(ctx: zengl.Context):
+    fence = ctx.fence()
+    assert fence.client_wait() is True
+
+
+def test_fence_release(ctx: zengl.Context):
+    fence = ctx.fence()
+    ctx.release(fence)
+    ctx.release(fence)
+
+    with pytest.raises(RuntimeError):
+        fence.client_wait()
+
+    with pytest.raises(RuntimeError):
+        fence.signaled
+
+    signaled = ctx.fence()
+    signaled.client_wait()
+    ctx.release(signaled)
@@ -0,0 +1,81 @@
+import ctypes
+import sys
+
+import numpy as np
+import zengl
+
+from utils import glsl
+
+GL_CULL_FACE = 0x0B44
+GL_FRONT_AND_BACK = 0x0408
+
+
+def make_triangle(ctx, framebuffer, **kwargs):
+    return ctx.pipeline(
+        vertex_shader=glsl('triangle.vert'),
+        fragment_shader=glsl('triangle.frag'),
+        framebuffer=framebuffer,
+        vertex_count=3,
+        **kwargs,
+    )
+
+
+def center_pixel(img):
+    return np.frombuffer(img.read(), 'u1').reshape(64, 64, 4)[32, 32].tolist()
+
+
+def test_state_restored_between_pipelines(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    img.clear_value = (0.0, 0.0, 1.0, 1.0)
+    triangle = make_triangle(ctx, [img])
+    masked = make_triangle(ctx, [img], color_mask=0)
+
+    img.clear()
+    masked.render()
+    assert center_pixel(img) == [0, 0, 255, 255]
+
+    triangle.render()
+    assert center_pixel(img) == [255, 0, 0, 255]
+
+    masked.render()
+    img.clear()
+    assert center_pixel(img) == [0, 0, 255, 255]
+
+    masked.render()
+    triangle.render()
+    assert center_pixel(img) == [255, 0, 0, 255]
+
+
+def test_invalidate_state(ctx: zengl.Context, loader):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    triangle = make_triangle(ctx, [img])
+    img.clear()
+    triangle.render()
+    assert center_pixel(img) == [255, 0, 0, 255]
+
+    # foreign code culls every face behind the back of zengl
+    gl_function = ctypes.WINFUNCTYPE if sys.platform == 'win32' else ctypes.CFUNCTYPE
+    gl_function(None, ctypes.c_uint)(loader.load('glEnable'))(GL_CULL_FACE)
+    gl_function(None, ctypes.c_uint)(loader.load('glCullFace'))(GL_FRONT_AND_BACK)
+    img.clear()
+    triangle.render()
+    assert center_pixel(img) == [0, 0, 0, 0]
+
+    ctx.invalidate_state()
+    img.clear()
+    triangle.render()
+    assert center_pixel(img) == [255, 0, 0, 255]
+
+
+def test_depth_func(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    depth = ctx.image((64, 64), 'depth24plus')
+    depth.clear_value = 0.0
+    less = make_triangle(ctx, [img, depth])
+    greater = make_triangle(ctx, [img, depth], depth={'test': True, 'write': True, 'func': 'greater'})
+    img.clear()
+    depth.clear()
+    less.render()
+    assert center_pixel(img) == [0, 0, 0, 0]
+    greater.render()
+    assert center_pixel(img) == [255, 0, 0, 255]
@@ -0,0 +1,42 @@
+import numpy as np
+import pytest
+import zengl
+
+
+def test_buffer_copy_to(ctx: zengl.Context):
+    src = ctx.buffer(bytes(range(64)))
+    dst = ctx.buffer(size=64)
+    src.copy_to(dst, 8, 32, 16)
+    data = dst.map().tobytes()
+    dst.unmap()
+    assert data[32:48] == bytes(range(8, 24))
+
+    src.copy_to(src, 0, 56, 8)
+    data = src.map().tobytes()
+    src.unmap()
+    assert data[56:] == bytes(range(8))
+
+    with pytest.raises(ValueError):
+        src.copy_to(dst, 56, size=16)
+
+    with pytest.raises(ValueError):
+        src.copy_to(src, 0, 8, 16)
+
+
+def test_image_buffer_roundtrip(ctx: zengl.Context):
+    data = np.random.randint(0, 255, (8, 8, 4), 'u1')
+    buf = ctx.buffer(size=16 + data.nbytes)
+    buf.write(data.tobytes(), 16)
+
+    img = ctx.image((16, 16), 'rgba8unorm')
+    img.write_from_buffer(buf, 16, (8, 8), offset=(4, 2))
+    full = np.frombuffer(img.read(), 'u1').reshape(16, 16, 4)
+    np.testing.assert_array_equal(full[2:10, 4:12], data)
+
+    out = ctx.buffer(size=data.nbytes)
+    img.read_to_buffer(out, 0, (8, 8), offset=(4, 2))
+    np.testing.assert_array_equal(np.frombuffer(out.map(), 'u1').reshape(8, 8, 4), data)
+    out.unmap()
+
+    with pytest.raises(ValueError):
+        img.read_to_buffer(out)
@@ -0,0 +1,50 @@
+import numpy as np
+import pytest
+import zengl
+
+
+def test_copy_region(ctx: zengl.Context):
+    data = np.random.randint(0, 255, (16, 16, 4), 'u1')
+    src = ctx.image((16, 16), 'rgba8unorm', data)
+    dst = ctx.image((16, 16), 'rgba8unorm')
+    src.copy(dst, (8, 4), offset=(2, 3), target_offset=(5, 6))
+    result = np.frombuffer(dst.read(), 'u1').reshape(16, 16, 4)
+    np.testing.assert_array_equal(result[6:10, 5:13], data[3:7, 2:10])
+
+
+def test_copy_layers(ctx: zengl.Context):
+    faces = np.random.randint(0, 255, (6, 4, 4, 4), 'u1')
+    cube = ctx.image((4, 4), 'rgba8unorm', faces, cubemap=True)
+    layers = ctx.image((4, 4), 'rgba8unorm', array=6)
+    for i in range(6):
+        cube.copy(layers, layer=i, target_layer=5 - i)
+    for i in range(6):
+        dest = bytearray(64)
+        layers.read_into(dest, layer=5 - i)
+        assert bytes(dest) == faces[i].tobytes()
+
+
+def test_copy_levels(ctx: zengl.Context):
+    data = np.random.randint(0, 255, (8, 8, 4), 'u1')
+    src = ctx.image((8, 8), 'rgba8unorm', data)
+    dst = ctx.image((16, 16), 'rgba8unorm')
+    dst.mipmaps()
+    src.copy(dst, target_level=1)
+    dest = bytearray(8 * 8 * 4)
+    dst.read_into(dest, level=1)
+    assert bytes(dest) == data.tobytes()
+
+    with pytest.raises(ValueError):
+        dst.copy(dst)
+
+
+def test_copy_depth(ctx: zengl.Context):
+    src = ctx.image((16, 16), 'depth24plus')
+    src.clear_value = 0.25
+    src.clear()
+    dst = ctx.image((16, 16), 'depth24plus')
+    src.copy(dst)
+    assert dst.read() == src.read()
+
+    with pytest.raises(TypeError):
+        src.copy(ctx.image((16, 16), 'rgba8unorm'))
@@ -0,0 +1,50 @@
+import sys
+import threading
+
+import numpy as np
+import zengl
+
+
+def test_large_buffer_write(ctx: zengl.Context):
+    data = np.random.randint(0, 255, 1 << 20, 'u1')
+    buf = ctx.buffer(data)
+    data[:] = data[::-1]
+    buf.write(data)
+    assert buf.map().tobytes() == data.tobytes()
+    buf.unmap()
+
+
+def test_large_image_write_read(ctx: zengl.Context):
+    data = np.random.randint(0, 255, (512, 512, 4), 'u1')
+    img = ctx.image((512, 512), 'rgba8unorm', data)
+    assert img.read() == data.tobytes()
+    data[:] = data[::-1]
+    img.write(data)
+    assert img.read() == data.tobytes()
+
+
+def test_large_transfer_releases_gil(ctx: zengl.Context):
+    buf = ctx.buffer(size=1 << 22)
+    data = bytes(1 << 22)
+    go = threading.Event()
+    seen = threading.Event()
+
+    def helper():
+        go.wait()
+        seen.set()
+
+    # with a long switch interval the helper only runs when the GIL is released voluntarily
+    interval = sys.getswitchinterval()
+    thread = threading.Thread(target=helper)
+    thread.start()
+    sys.setswitchinterval(100.0)
+    try:
+        go.set()
+        for _ in range(100):
+            buf.write(data)
+            if seen.is_set():
+                break
+        assert seen.is_set()
+    finally:
+        sys.setswitchinterval(interval)
+        thread.join()
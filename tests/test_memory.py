@@ -0,0 +1,57 @@
+import pytest
+import zengl
+
+
+@pytest.fixture
+def budget_ctx(ctx: zengl.Context):
+    yield ctx
+    ctx.memory_budget = None
+    ctx.memory_hook = None
+
+
+def test_memory(ctx: zengl.Context):
+    before = ctx.memory()
+    buffer = ctx.buffer(size=1024)
+    image = ctx.image((16, 16), 'rgba8unorm')
+    renderbuffer = ctx.image((8, 8), 'rgba8unorm', samples=4)
+
+    memory = ctx.memory()
+    assert memory['buffers'] == before['buffers'] + 1024
+    assert memory['images'] == before['images'] + 16 * 16 * 4
+    assert memory['renderbuffers'] == before['renderbuffers'] + 8 * 8 * 4 * 4
+    assert memory['total'] == sum(memory[key] for key in ['buffers', 'images', 'renderbuffers', 'staging'])
+
+    image.mipmaps()
+    assert ctx.memory()['images'] == before['images'] + (256 + 64 + 16 + 4 + 1) * 4
+
+    ctx.release_many([buffer, image, renderbuffer])
+    assert ctx.memory()['total'] == before['total']
+
+
+def test_memory_budget(budget_ctx: zengl.Context):
+    ctx = budget_ctx
+    ctx.memory_budget = ctx.memory()['total'] + 4096
+    buffer = ctx.buffer(size=4096)
+    with pytest.raises(MemoryError):
+        ctx.buffer(size=16)
+    with pytest.raises(MemoryError):
+        ctx.image((4, 4), 'rgba8unorm')
+    ctx.release(buffer)
+    ctx.release(ctx.buffer(size=16))
+
+
+def test_memory_hook(budget_ctx: zengl.Context):
+    ctx = budget_ctx
+    ctx.memory_budget = ctx.memory()['total'] + 4096
+    buffers = [ctx.buffer(size=4096)]
+    requests = []
+
+    def evict(kind, size):
+        requests.append((kind, size))
+        ctx.release(buffers.pop())
+
+    ctx.memory_hook = evict
+    image = ctx.image((32, 32), 'rgba8unorm')
+    assert requests == [('image', 4096)]
+    assert not buffers
+    ctx.release(image)
@@ -0,0 +1,124 @@
+import array
+import struct
+
+import pytest
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    vec2 positions[6] = vec2[](
+        vec2(-1.0, -1.0),
+        vec2(3.0, -1.0),
+        vec2(-1.0, 3.0),
+        vec2(-1.0, -1.0),
+        vec2(-0.5, -1.0),
+        vec2(-1.0, -0.5)
+    );
+
+    void main() {
+        gl_Position = vec4(positions[gl_VertexID], DEPTH, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = vec4(1.0, 1.0, 1.0, 1.0);
+    }
+'''
+
+
+def make_pipeline(ctx, img, depth, value, vertex_count=3):
+    return ctx.pipeline(
+        vertex_shader=vertex_shader.replace('DEPTH', str(value)),
+        fragment_shader=fragment_shader,
+        framebuffer=[img, depth],
+        vertex_count=vertex_count,
+    )
+
+
+def test_render_occlusion(ctx: zengl.Context):
+    img = ctx.image((16, 16), 'rgba8unorm')
+    depth = ctx.image((16, 16), 'depth24plus')
+    depth.clear()
+
+    proxies = make_pipeline(ctx, img, depth, 0.0, vertex_count=3)
+    queries = [ctx.query('samples_passed') for _ in range(2)]
+    proxies.render_occlusion(queries)
+    assert queries[0].result() == 16 * 16
+    small = queries[1].result()
+    assert 0 < small < 16 * 16
+
+    # color and depth were not written
+    assert img.read() == bytes(16 * 16 * 4)
+    proxies.render_occlusion(queries[:1], ranges=struct.pack('2i', 3, 3))
+    assert queries[0].result() == small
+
+    with pytest.raises(ValueError):
+        proxies.render_occlusion(queries, ranges=struct.pack('2i', 0, 3))
+
+    with pytest.raises(TypeError):
+        proxies.render_occlusion(queries[:1], ranges=array.array('f', [3.0, 3.0]))
+
+    with pytest.raises(ValueError):
+        proxies.render_occlusion([ctx.query('time_elapsed')])
+
+    with pytest.raises(TypeError):
+        proxies.render_occlusion([None])
+
+
+def test_conditional_render(ctx: zengl.Context):
+    img = ctx.image((16, 16), 'rgba8unorm')
+    depth = ctx.image((16, 16), 'depth24plus')
+    depth.clear()
+
+    occluder = make_pipeline(ctx, img, depth, -0.5)
+    proxy = make_pipeline(ctx, img, depth, 0.5)
+    visible = make_pipeline(ctx, img, depth, -0.8)
+
+    occluder.render()
+    img.clear()
+
+    hidden = ctx.query('any_samples_passed')
+    passed = ctx.query('any_samples_passed')
+    proxy.render_occlusion([hidden])
+    visible.render_occlusion([passed])
+    assert hidden.result() == 0
+    assert passed.result() == 1
+
+    proxy.render(condition=hidden)
+    assert img.read() == bytes(16 * 16 * 4)
+    visible.render(condition=passed)
+    assert img.read() == b'\xff' * (16 * 16 * 4)
+
+    with pytest.raises(RuntimeError):
+        visible.render(condition=ctx.query('any_samples_passed'))
+
+    with pytest.raises(ValueError):
+        visible.render(condition=ctx.query('timestamp'))
+
+
+def test_occlusion_queries_share_slot(ctx: zengl.Context):
+    img = ctx.image((16, 16), 'rgba8unorm')
+    depth = ctx.image((16, 16), 'depth24plus')
+    proxies = make_pipeline(ctx, img, depth, 0.0, vertex_count=3)
+
+    samples = ctx.query('samples_passed')
+    any_samples = ctx.query('any_samples_passed')
+    samples.begin()
+
+    with pytest.raises(RuntimeError):
+        any_samples.begin()
+
+    with pytest.raises(RuntimeError):
+        proxies.render_occlusion([any_samples])
+
+    samples.end()
+    any_samples.begin()
+    any_samples.end()
+    ctx.release(samples)
+    ctx.release(any_samples)
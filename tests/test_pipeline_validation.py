@@ -0,0 +1,104 @@
+import pytest
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    layout (std140) uniform Common {
+        mat4 mvp;
+    };
+
+    layout (location = 0) in vec2 in_vert;
+
+    void main() {
+        gl_Position = mvp * vec4(in_vert, 0.0, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    uniform sampler2D Texture;
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = texture(Texture, vec2(0.5, 0.5));
+    }
+'''
+
+
+@pytest.fixture
+def desc(ctx: zengl.Context):
+    img = ctx.image((4, 4), 'rgba8unorm')
+    depth = ctx.image((4, 4), 'depth24plus-stencil8')
+    return dict(
+        vertex_shader=vertex_shader,
+        fragment_shader=fragment_shader,
+        layout=[
+            {'name': 'Common', 'binding': 0},
+            {'name': 'Texture', 'binding': 0},
+        ],
+        resources=[
+            {'type': 'uniform_buffer', 'binding': 0, 'buffer': ctx.buffer(size=64)},
+            {'type': 'sampler', 'binding': 0, 'image': ctx.image((4, 4), 'rgba8unorm'), 'border_color': [1, 0, 0, 1]},
+        ],
+        framebuffer=[img, depth],
+        vertex_buffers=zengl.bind(ctx.buffer(size=64), '2f', 0),
+        blending={'enable': True, 'src_color': 'src_alpha', 'dst_color': 'one_minus_src_alpha'},
+        stencil={'test': True, 'both': {'pass_op': 'replace', 'reference': 1}},
+        depth={'test': True, 'write': False, 'func': 'lequal'},
+        polygon_offset={'factor': 1.0, 'units': 2.0},
+        topology='triangle_strip',
+        vertex_count=4,
+    )
+
+
+def test_pipeline_cache_keys(ctx: zengl.Context, desc):
+    ctx.pipeline(**desc)
+    ctx.reset_stats()
+    ctx.pipeline(**desc)
+    caches = ctx.stats()['caches']
+    for name in ['framebuffer', 'vertex_array', 'descriptor_set_buffers', 'descriptor_set_images', 'global_settings']:
+        assert caches[name]['misses'] == 0
+
+
+@pytest.mark.parametrize('override, error, message', [
+    ({'topology': 'quads'}, KeyError, 'quads'),
+    ({'cull_face': 'left'}, KeyError, 'left'),
+    ({'depth': {'test': True, 'write': True, 'func': 'sometimes'}}, KeyError, 'sometimes'),
+    ({'vertex_buffers': []}, ValueError, 'Unbound vertex attribute "in_vert" at location 0'),
+    ({'layout': [{'name': 'Common', 'binding': 0}]}, ValueError, 'Missing layout binding for "Texture"'),
+    ({'resources': []}, ValueError, 'Missing resource for "Texture" with binding 0'),
+])
+def test_pipeline_errors(ctx: zengl.Context, desc, override, error, message):
+    desc.update(override)
+    with pytest.raises(error, match=message):
+        ctx.pipeline(**desc)
+
+
+def test_resource_errors(ctx: zengl.Context, desc):
+    uniform_buffer, sampler = desc['resources']
+    with pytest.raises(ValueError, match='Invalid resource type "image"'):
+        ctx.pipeline(**dict(desc, resources=[uniform_buffer, sampler, {'type': 'image', 'binding': 1}]))
+
+    with pytest.raises(ValueError, match='Duplicate sampler binding for "Texture" with binding 0'):
+        ctx.pipeline(**dict(desc, resources=[uniform_buffer, sampler, sampler]))
+
+    small = dict(uniform_buffer, buffer=ctx.buffer(size=16))
+    with pytest.raises(ValueError, match='Uniform buffer is too small 16 is less than 64'):
+        ctx.pipeline(**dict(desc, resources=[small, sampler]))
+
+
+def test_framebuffer_errors(ctx: zengl.Context, desc):
+    img, depth = desc['framebuffer']
+    with pytest.raises(ValueError, match='must be the last item'):
+        ctx.pipeline(**dict(desc, framebuffer=[depth, img]))
+
+    with pytest.raises(ValueError, match='same size'):
+        ctx.pipeline(**dict(desc, framebuffer=[img, ctx.image((2, 2), 'rgba8unorm')]))
+
+
+def test_invalid_image_format(ctx: zengl.Context):
+    with pytest.raises(ValueError):
+        ctx.image((4, 4), 'rgb8unorm')
@@ -0,0 +1,83 @@
+import pytest
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    vec2 positions[3] = vec2[](
+        vec2(-1.0, -1.0),
+        vec2(3.0, -1.0),
+        vec2(-1.0, 3.0)
+    );
+
+    void main() {
+        gl_Position = vec4(positions[gl_VertexID], 0.0, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = vec4(COLOR, 1.0);
+    }
+'''
+
+
+def pipeline_desc(img, color):
+    return dict(
+        vertex_shader=vertex_shader,
+        fragment_shader=fragment_shader.replace('COLOR', color),
+        framebuffer=[img],
+        vertex_count=3,
+    )
+
+
+def test_pipelines(ctx: zengl.Context):
+    img = ctx.image((4, 4), 'rgba8unorm')
+    colors = ['1.0, 0.0, 0.0', '0.0, 1.0, 0.0', '0.0, 0.0, 1.0']
+    pipelines = ctx.pipelines([pipeline_desc(img, color) for color in colors])
+    assert len(pipelines) == 3
+
+    expected = [b'\xff\x00\x00\xff', b'\x00\xff\x00\xff', b'\x00\x00\xff\xff']
+    for pipeline, pixel in zip(pipelines, expected):
+        pipeline.render()
+        assert img.read() == pixel * 16
+
+
+def test_pipelines_shared_program(ctx: zengl.Context):
+    img = ctx.image((4, 4), 'rgba8unorm')
+    before = ctx.stats()['caches']['program']['misses']
+    pipelines = ctx.pipelines([pipeline_desc(img, '0.5, 0.5, 0.5') for _ in range(4)])
+    assert len(pipelines) == 4
+    assert ctx.stats()['caches']['program']['misses'] == before + 1
+
+
+def test_pipelines_compile_error(ctx: zengl.Context):
+    img = ctx.image((4, 4), 'rgba8unorm')
+    size = ctx.stats()['caches']['program']['size']
+    with pytest.raises(ValueError):
+        ctx.pipelines([
+            pipeline_desc(img, '0.25, 0.25, 0.25'),
+            pipeline_desc(img, 'undefined_symbol'),
+        ])
+    assert ctx.stats()['caches']['program']['size'] == size
+
+
+def test_pipelines_invalid_last(ctx: zengl.Context):
+    img = ctx.image((4, 4), 'rgba8unorm')
+    caches = ctx.stats()['caches']
+    invalid = pipeline_desc(img, '0.75, 0.75, 0.75')
+    del invalid['framebuffer']
+    with pytest.raises(TypeError):
+        ctx.pipelines([
+            pipeline_desc(img, '0.125, 0.125, 0.125'),
+            pipeline_desc(img, '0.375, 0.375, 0.375'),
+            invalid,
+        ])
+    after = ctx.stats()['caches']
+    assert after['program']['size'] == caches['program']['size']
+    assert after['framebuffer']['size'] == caches['framebuffer']['size']
+    assert after['global_settings']['size'] == caches['global_settings']['size']
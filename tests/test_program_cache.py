@@ -0,0 +1,62 @@
+import pytest
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    vec2 positions[3] = vec2[](
+        vec2(-1.0, -1.0),
+        vec2(3.0, -1.0),
+        vec2(-1.0, 3.0)
+    );
+
+    void main() {
+        gl_Position = vec4(positions[gl_VertexID], 0.0, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = vec4(0.0, 1.0, 0.0, 1.0);
+    }
+'''
+
+
+def render(program_cache):
+    ctx = zengl.context(zengl.loader(headless=True), program_cache=program_cache)
+    img = ctx.image((4, 4), 'rgba8unorm')
+    pipeline = ctx.pipeline(
+        vertex_shader=vertex_shader,
+        fragment_shader=fragment_shader,
+        framebuffer=[img],
+        vertex_count=3,
+    )
+    pipeline.render()
+    assert img.read() == b'\x00\xff\x00\xff' * 16
+    return ctx.stats()['caches']['program_binary']
+
+
+def test_program_cache(tmp_path):
+    program_cache = tmp_path / 'programs'
+    first = render(program_cache)
+    files = list(program_cache.iterdir())
+    if not files:
+        pytest.skip('program binaries are not supported')
+
+    assert first == {'hits': 0, 'misses': 1}
+    assert render(program_cache) == {'hits': 1, 'misses': 0}
+
+    files[0].write_bytes(b'corrupted')
+    assert render(program_cache) == {'hits': 0, 'misses': 1}
+    assert render(program_cache) == {'hits': 1, 'misses': 0}
+
+    # same file name and hash but a different check hash, as for a colliding key
+    data = bytearray(files[0].read_bytes())
+    data[16] ^= 0xff
+    files[0].write_bytes(bytes(data))
+    assert render(program_cache) == {'hits': 0, 'misses': 1}
+    assert render(program_cache) == {'hits': 1, 'misses': 0}
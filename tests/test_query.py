@@ -0,0 +1,135 @@
+import time
+
+import pytest
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    vec2 positions[3] = vec2[](
+        vec2(-1.0, -1.0),
+        vec2(3.0, -1.0),
+        vec2(-1.0, 3.0)
+    );
+
+    void main() {
+        gl_Position = vec4(positions[gl_VertexID], 0.0, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = vec4(1.0, 1.0, 1.0, 1.0);
+    }
+'''
+
+
+def make_pipeline(ctx, img):
+    return ctx.pipeline(
+        vertex_shader=vertex_shader,
+        fragment_shader=fragment_shader,
+        framebuffer=[img],
+        vertex_count=3,
+    )
+
+
+def test_query_counts(ctx: zengl.Context):
+    img = ctx.image((16, 16), 'rgba8unorm')
+    pipeline = make_pipeline(ctx, img)
+
+    samples = ctx.query('samples_passed')
+    primitives = ctx.query('primitives_generated')
+    samples.begin()
+    primitives.begin()
+    pipeline.render()
+    primitives.end()
+    samples.end()
+    assert samples.result() == 16 * 16
+    assert primitives.result() == 1
+    assert samples.kind == 'samples_passed'
+
+    with pytest.raises(RuntimeError):
+        samples.end()
+
+    with pytest.raises(ValueError):
+        ctx.query('unknown')
+
+
+def test_query_time(ctx: zengl.Context):
+    img = ctx.image((16, 16), 'rgba8unorm')
+    pipeline = make_pipeline(ctx, img)
+
+    start = ctx.query('timestamp')
+    elapsed = ctx.query('time_elapsed')
+    start.end()
+    elapsed.begin()
+    pipeline.render()
+    elapsed.end()
+    assert elapsed.result() >= 0
+    assert start.result(wait=True) is not None
+
+    with pytest.raises(TypeError):
+        start.begin()
+
+
+def test_render_profile(ctx: zengl.Context):
+    img = ctx.image((16, 16), 'rgba8unorm')
+    pipeline = make_pipeline(ctx, img)
+    for _ in range(4):
+        pipeline.render(profile=True)
+    img.read()
+    deadline = time.time() + 5.0
+    while pipeline.gpu_time_count < 4 and time.time() < deadline:
+        time.sleep(0.01)
+    assert pipeline.gpu_time_count == 4
+    assert pipeline.gpu_time >= 0
+
+
+def test_query_release(ctx: zengl.Context):
+    img = ctx.image((16, 16), 'rgba8unorm')
+    pipeline = make_pipeline(ctx, img)
+
+    active = ctx.query('samples_passed')
+    active.begin()
+    ctx.release(active)
+    ctx.release(active)
+
+    with pytest.raises(RuntimeError):
+        active.begin()
+
+    with pytest.raises(RuntimeError):
+        active.result()
+
+    samples = ctx.query('samples_passed')
+    samples.begin()
+    pipeline.render()
+    samples.end()
+    assert samples.result() == 16 * 16
+    ctx.release(samples)
+
+
+def test_query_dropped_while_active(ctx: zengl.Context):
+    img = ctx.image((16, 16), 'rgba8unorm')
+    pipeline = make_pipeline(ctx, img)
+
+    dropped = ctx.query('time_elapsed')
+    dropped.begin()
+    del dropped
+
+    elapsed = ctx.query('time_elapsed')
+    elapsed.begin()
+    pipeline.render()
+    elapsed.end()
+    assert elapsed.result() >= 0
+
+    pipeline.render(profile=True)
+    img.read()
+    deadline = time.time() + 5.0
+    while pipeline.gpu_time_count < 1 and time.time() < deadline:
+        time.sleep(0.01)
+    assert pipeline.gpu_time_count == 1
+    ctx.release(elapsed)
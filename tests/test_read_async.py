@@ -0,0 +1,24 @@
+import numpy as np
+import zengl
+
+
+def test_read_async(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    img.clear_value = (1.0, 0.0, 0.0, 1.0)
+    img.clear()
+    first = img.read_async()
+    img.clear_value = (0.0, 0.0, 1.0, 1.0)
+    img.clear()
+    second = img.read_async(size=(2, 2), offset=(4, 4))
+
+    assert first.wait(1.0)
+    assert first.result() == bytes([255, 0, 0, 255]) * 64 * 64
+    assert second.result() == bytes([0, 0, 255, 255]) * 4
+    assert second.ready()
+
+
+def test_read_async_unaligned(ctx: zengl.Context):
+    data = np.arange(15, dtype='u1')
+    img = ctx.image((5, 3), 'r8unorm', data)
+    assert img.read() == data.tobytes()
+    assert img.read_async().result() == data.tobytes()
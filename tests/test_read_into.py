@@ -0,0 +1,48 @@
+import numpy as np
+import pytest
+import zengl
+
+
+def test_read_into(ctx: zengl.Context):
+    data = np.random.randint(0, 255, (16, 16, 4), 'u1')
+    img = ctx.image((16, 16), 'rgba8unorm', data)
+    dest = np.zeros((16, 16, 4), 'u1')
+    img.read_into(dest)
+    np.testing.assert_array_equal(dest, data)
+
+
+def test_read_into_stride(ctx: zengl.Context):
+    data = np.random.randint(0, 255, (16, 16, 4), 'u1')
+    img = ctx.image((16, 16), 'rgba8unorm', data)
+    dest = np.zeros((8, 32, 4), 'u1')
+    img.read_into(dest.reshape(-1)[16:], (8, 8), offset=(2, 3), stride=32 * 4)
+    np.testing.assert_array_equal(dest[:, 4:12], data[3:11, 2:10])
+    assert not dest[:, :4].any() and not dest[:, 12:].any()
+
+    with pytest.raises(ValueError):
+        img.read_into(bytearray(16 * 16 * 4 - 1))
+
+
+def test_read_into_layers(ctx: zengl.Context):
+    faces = np.random.randint(0, 255, (6, 4, 4, 4), 'u1')
+    cube = ctx.image((4, 4), 'rgba8unorm', faces, cubemap=True)
+    layers = ctx.image((4, 4), 'rgba8unorm', faces, array=6)
+    dest = bytearray(64)
+    for i in range(6):
+        cube.read_into(dest, layer=i)
+        assert dest == faces[i].tobytes()
+        layers.read_into(dest, layer=i)
+        assert dest == faces[i].tobytes()
+
+
+def test_read_into_level(ctx: zengl.Context):
+    img = ctx.image((8, 8), 'rgba8unorm', np.full((8, 8, 4), 200, 'u1'))
+    img.mipmaps()
+    dest = bytearray(4 * 4 * 4)
+    img.read_into(dest, level=1)
+    assert dest == bytes([200]) * 64
+    img.read_into(dest, (1, 1), level=3)
+    assert dest[:4] == bytes([200]) * 4
+
+    with pytest.raises(ValueError):
+        img.read_into(dest, level=4)
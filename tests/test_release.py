@@ -0,0 +1,62 @@
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    vec2 positions[3] = vec2[](
+        vec2(-1.0, -1.0),
+        vec2(3.0, -1.0),
+        vec2(-1.0, 3.0)
+    );
+
+    void main() {
+        gl_Position = vec4(positions[gl_VertexID], 0.0, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    uniform sampler2D Texture;
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = texture(Texture, vec2(0.5, 0.5));
+    }
+'''
+
+
+def cache_sizes(ctx):
+    caches = ctx.stats()['caches']
+    return {name: caches[name]['size'] for name in ['sampler', 'descriptor_set_images', 'framebuffer', 'program']}
+
+
+def test_release_many(ctx: zengl.Context):
+    before = cache_sizes(ctx)
+    img = ctx.image((4, 4), 'rgba8unorm')
+    texture = ctx.image((1, 1), 'rgba8unorm', b'\x00\xff\x00\xff')
+    pipelines = [
+        ctx.pipeline(
+            vertex_shader=vertex_shader,
+            fragment_shader=fragment_shader,
+            layout=[{'name': 'Texture', 'binding': 0}],
+            resources=[{'type': 'sampler', 'binding': 0, 'image': texture, 'min_lod': float(i)}],
+            framebuffer=[img],
+            vertex_count=3,
+        )
+        for i in range(8)
+    ]
+    pipelines[0].render()
+    assert img.read() == b'\x00\xff\x00\xff' * 16
+
+    after = cache_sizes(ctx)
+    assert after['sampler'] == before['sampler'] + 8
+    assert after['program'] == before['program'] + 1
+
+    ctx.release_many(pipelines[:4])
+    assert cache_sizes(ctx)['sampler'] == before['sampler'] + 4
+    assert cache_sizes(ctx)['program'] == before['program'] + 1
+
+    ctx.release_many(pipelines[4:] + [img, texture])
+    assert cache_sizes(ctx) == before
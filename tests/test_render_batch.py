@@ -0,0 +1,31 @@
+import numpy as np
+import pytest
+import zengl
+
+from utils import glsl
+
+
+def test_render_batch(ctx: zengl.Context):
+    img = ctx.image((256, 256), 'rgba8unorm')
+    triangle = ctx.pipeline(
+        vertex_shader=glsl('triangle.vert'),
+        fragment_shader=glsl('triangle.frag'),
+        framebuffer=[img],
+        vertex_count=3,
+    )
+    img.clear()
+    triangle.render()
+    expected = img.read()
+    img.clear()
+    ctx.render([triangle, triangle])
+    np.testing.assert_array_equal(np.frombuffer(img.read(), 'u1'), np.frombuffer(expected, 'u1'))
+    img.clear()
+    ctx.render(pipeline for pipeline in [triangle])
+    np.testing.assert_array_equal(np.frombuffer(img.read(), 'u1'), np.frombuffer(expected, 'u1'))
+
+
+def test_render_batch_invalid(ctx: zengl.Context):
+    with pytest.raises(TypeError):
+        ctx.render([None])
+    with pytest.raises(TypeError, match='iterable of pipelines'):
+        ctx.render(None)
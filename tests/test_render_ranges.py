@@ -0,0 +1,94 @@
+import array
+
+import numpy as np
+import pytest
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    layout (location = 0) in vec2 in_vertex;
+
+    void main() {
+        gl_Position = vec4(in_vertex, 0.0, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = vec4(1.0, 1.0, 1.0, 1.0);
+    }
+'''
+
+
+def quad(x0, y0, x1, y1):
+    return [x0, y0, x1, y0, x0, y1, x0, y1, x1, y0, x1, y1]
+
+
+def make_pipeline(ctx, img, **kwargs):
+    vertices = np.array(quad(-1.0, -1.0, 0.0, 0.0) + quad(0.0, 0.0, 1.0, 1.0) + quad(-1.0, 0.0, 0.0, 1.0), 'f4')
+    return ctx.pipeline(
+        vertex_shader=vertex_shader,
+        fragment_shader=fragment_shader,
+        framebuffer=[img],
+        vertex_buffers=zengl.bind(ctx.buffer(vertices), '2f', 0),
+        **kwargs,
+    )
+
+
+def covered(img):
+    pixels = np.frombuffer(img.read(), 'u1').reshape(64, 64, 4)
+    return [pixels[16, 16, 0] == 255, pixels[48, 48, 0] == 255, pixels[48, 16, 0] == 255]
+
+
+@pytest.mark.parametrize('instance_count', [1, 2])
+def test_render_ranges(ctx: zengl.Context, instance_count):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    pipeline = make_pipeline(ctx, img)
+    img.clear()
+    pipeline.render_ranges(np.array([[0, 6, instance_count], [12, 6, 1]], 'i4'))
+    assert covered(img) == [True, False, True]
+
+
+def test_render_ranges_indexed(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    pipeline = make_pipeline(ctx, img, index_buffer=ctx.buffer(np.arange(18, dtype='i4')))
+    img.clear()
+    pipeline.render_ranges(np.array([[6, 6, 1], [12, 6, 1]], 'i4'))
+    assert covered(img) == [False, True, True]
+
+
+def test_render_ranges_invalid(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    pipeline = make_pipeline(ctx, img)
+    with pytest.raises(ValueError):
+        pipeline.render_ranges(np.array([0, 6], 'i4'))
+
+
+def test_render_ranges_empty(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    pipeline = make_pipeline(ctx, img)
+    img.clear()
+    pipeline.render_ranges(np.zeros((0, 3), 'i4'))
+    pipeline.render_ranges(b'', base_vertex=True)
+    assert covered(img) == [False, False, False]
+
+
+def test_render_ranges_format(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    pipeline = make_pipeline(ctx, img)
+    with pytest.raises(TypeError):
+        pipeline.render_ranges(np.array([[0, 6, 1]], 'i8'))
+    with pytest.raises(TypeError):
+        pipeline.render_ranges(np.array([[0, 6, 1, 0, 0, 0]], 'f4'))
+    with pytest.raises(TypeError):
+        pipeline.render_ranges(array.array('d', [0.0, 0.0, 0.0]))
+
+    img.clear()
+    pipeline.render_ranges(array.array('i', [0, 6, 1]))
+    pipeline.render_ranges(np.array([12, 6, 1], 'i4').tobytes())
+    assert covered(img) == [True, False, True]
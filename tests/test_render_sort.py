@@ -0,0 +1,36 @@
+import numpy as np
+import zengl
+
+from utils import glsl
+
+
+def test_render_sort(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    depth = ctx.image((64, 64), 'depth24plus')
+
+    def triangle(**kwargs):
+        return ctx.pipeline(
+            vertex_shader=glsl('triangle.vert'),
+            fragment_shader=glsl('triangle.frag'),
+            framebuffer=[img, depth],
+            vertex_count=3,
+            **kwargs,
+        )
+
+    opaque = triangle()
+    masked = triangle(color_mask=0, depth={'test': True, 'func': 'always', 'write': False}, layer=-1)
+    blended = triangle(depth=False, blending={'enable': True, 'src_color': 'zero', 'dst_color': 'zero'})
+    assert masked.layer == -1
+
+    img.clear()
+    depth.clear()
+    ctx.render([blended, opaque, masked], sort=True)
+    pixels = np.frombuffer(img.read(), 'u1').reshape(64, 64, 4)
+    assert pixels[32, 32].tolist() == [0, 0, 0, 255]
+
+    blended.layer = -1
+    img.clear()
+    depth.clear()
+    ctx.render([blended, opaque, masked], sort=True)
+    pixels = np.frombuffer(img.read(), 'u1').reshape(64, 64, 4)
+    assert pixels[32, 32].tolist() == [255, 0, 0, 255]
@@ -0,0 +1,140 @@
+import numpy as np
+import pytest
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    vec2 positions[3] = vec2[](
+        vec2(-1.0, -1.0),
+        vec2(3.0, -1.0),
+        vec2(-1.0, 3.0)
+    );
+
+    void main() {
+        gl_Position = vec4(positions[gl_VertexID], 0.0, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    layout (std140) uniform Common {
+        vec4 color;
+    };
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = color;
+    }
+'''
+
+
+def test_ring_buffer_frames(ctx: zengl.Context):
+    ring = ctx.ring_buffer(256, frames=2)
+    img = ctx.image((4, 4), 'rgba8unorm')
+    pipeline = ctx.pipeline(
+        vertex_shader=vertex_shader,
+        fragment_shader=fragment_shader,
+        layout=[{'name': 'Common', 'binding': 0}],
+        resources=[{'type': 'uniform_buffer', 'binding': 0, 'buffer': ring.buffer, 'offset': 0, 'size': 16}],
+        framebuffer=[img],
+        vertex_count=3,
+    )
+
+    for color in [(1.0, 0.0, 0.0, 1.0), (0.0, 1.0, 0.0, 1.0), (0.0, 0.0, 1.0, 1.0)]:
+        assert ring.write(np.array(color, 'f4')) == 0
+        pipeline.render()
+        assert img.read()[:4] == bytes(int(x * 255) for x in color)
+        ctx.end_frame()
+
+    assert ring.frame == 1
+
+
+def test_ring_buffer_alignment(ctx: zengl.Context):
+    ring = ctx.ring_buffer(1024)
+    first = ring.write(b'\x00' * 4)
+    second = ring.write(b'\x00' * 4)
+    assert first == 0 and second > 0 and second % 4 == 0
+    assert ring.used == second + 4
+
+    with pytest.raises(ValueError):
+        ring.write(b'\x00' * 1024)
+
+    with pytest.raises(TypeError):
+        ring.buffer.write(b'\x00' * 4)
+
+    ring.next_frame()
+    assert ring.used == 0
+    ctx.release(ring)
+
+    with pytest.raises(RuntimeError):
+        ring.write(b'\x00' * 4)
+
+    with pytest.raises(RuntimeError):
+        ring.next_frame()
+
+
+def test_ring_buffer_release_backing_buffer(ctx: zengl.Context):
+    ring = ctx.ring_buffer(size=256)
+    with pytest.raises(ValueError):
+        ctx.release(ring.buffer)
+
+    ring.write(b'\x00' * 4)
+    ctx.release(ring)
+    ctx.release(ring)
+    del ring
+
+    buf = ctx.buffer(size=64)
+    ctx.release(buf)
+    ctx.release(buf)
+
+
+vertex_data_shader = '''
+    #version 330
+
+    layout (location = 0) in vec2 in_vertex;
+
+    void main() {
+        gl_Position = vec4(in_vertex, 0.0, 1.0);
+    }
+'''
+
+solid_shader = '''
+    #version 330
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = vec4(1.0, 1.0, 1.0, 1.0);
+    }
+'''
+
+
+def test_ring_buffer_vertex_data(ctx: zengl.Context):
+    ring = ctx.ring_buffer(256, frames=2)
+    vertices = ctx.buffer(size=24)
+    img = ctx.image((4, 4), 'rgba8unorm')
+
+    with pytest.raises(ValueError, match='ring buffers'):
+        ctx.pipeline(
+            vertex_shader=vertex_data_shader,
+            fragment_shader=solid_shader,
+            framebuffer=[img],
+            vertex_buffers=zengl.bind(ring.buffer, '2f', 0),
+            vertex_count=3,
+        )
+
+    with pytest.raises(ValueError, match='ring buffers'):
+        ctx.pipeline(
+            vertex_shader=vertex_data_shader,
+            fragment_shader=solid_shader,
+            framebuffer=[img],
+            vertex_buffers=zengl.bind(vertices, '2f', 0),
+            index_buffer=ring.buffer,
+            vertex_count=3,
+        )
+
+    ctx.release(vertices)
+    ctx.release(ring)
@@ -0,0 +1,79 @@
+import pytest
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    vec2 positions[3] = vec2[](
+        vec2(-1.0, -1.0),
+        vec2(3.0, -1.0),
+        vec2(-1.0, 3.0)
+    );
+
+    void main() {
+        gl_Position = vec4(positions[gl_VertexID], 0.0, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    #include "color"
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = color;
+    }
+'''
+
+
+def render(ctx, img):
+    pipeline = ctx.pipeline(
+        vertex_shader=vertex_shader,
+        fragment_shader=fragment_shader,
+        framebuffer=[img],
+        vertex_count=3,
+    )
+    pipeline.render()
+    return img.read()[:4]
+
+
+def test_nested_includes(ctx: zengl.Context):
+    img = ctx.image((4, 4), 'rgba8unorm')
+    ctx.includes['red'] = 'vec4(1.0, 0.0, 0.0, 1.0)'
+    ctx.includes['green'] = 'vec4(0.0, 1.0, 0.0, 1.0)'
+    ctx.includes['color'] = 'const vec4 color = #include "red";'
+    assert render(ctx, img) == b'\xff\x00\x00\xff'
+
+
+def test_include_invalidation(ctx: zengl.Context):
+    img = ctx.image((4, 4), 'rgba8unorm')
+    ctx.includes['red'] = 'vec4(1.0, 0.0, 0.0, 1.0)'
+    ctx.includes['green'] = 'vec4(0.0, 1.0, 0.0, 1.0)'
+    ctx.includes['color'] = 'const vec4 color = #include "red";'
+    assert render(ctx, img) == b'\xff\x00\x00\xff'
+
+    hits = ctx.stats()['caches']['source']['hits']
+    assert render(ctx, img) == b'\xff\x00\x00\xff'
+    assert ctx.stats()['caches']['source']['hits'] == hits + 2
+
+    ctx.includes['green'] = 'vec4(0.0, 0.0, 1.0, 1.0)'
+    misses = ctx.stats()['caches']['source']['misses']
+    assert render(ctx, img) == b'\xff\x00\x00\xff'
+    assert ctx.stats()['caches']['source']['misses'] == misses
+
+    ctx.includes['red'] = 'vec4(1.0, 1.0, 0.0, 1.0)'
+    assert render(ctx, img) == b'\xff\xff\x00\xff'
+    assert ctx.stats()['caches']['source']['misses'] == misses + 1
+
+
+def test_include_errors(ctx: zengl.Context):
+    img = ctx.image((4, 4), 'rgba8unorm')
+    ctx.includes.pop('color', None)
+    with pytest.raises(KeyError):
+        render(ctx, img)
+
+    ctx.includes['color'] = '#include "color"'
+    with pytest.raises(ValueError, match='recursive include'):
+        render(ctx, img)
@@ -0,0 +1,60 @@
+import numpy as np
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    layout (location = 0) in vec2 in_vertex;
+
+    void main() {
+        gl_Position = vec4(in_vertex, 0.0, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = vec4(1.0, 1.0, 1.0, 1.0);
+    }
+'''
+
+
+def test_stats(ctx: zengl.Context):
+    img = ctx.image((16, 16), 'rgba8unorm')
+    vbo = ctx.buffer(np.array([-1.0, -1.0, 3.0, -1.0, -1.0, 3.0], 'f4'))
+
+    def make_pipeline():
+        return ctx.pipeline(
+            vertex_shader=vertex_shader,
+            fragment_shader=fragment_shader,
+            framebuffer=[img],
+            vertex_buffers=zengl.bind(vbo, '2f', 0),
+            vertex_count=3,
+        )
+
+    ctx.reset_stats()
+    first = make_pipeline()
+    second = make_pipeline()
+    first.render()
+    second.render()
+    vbo.write(bytes(8))
+    img.read()
+
+    stats = ctx.stats()
+    assert stats['draw_calls'] == 2
+    assert stats['vertices'] == 6
+    assert stats['instances'] == 2
+    assert stats['state_changes']['program'][1] >= 1
+    assert stats['state_changes']['vertex_array'][1] >= 1
+    assert stats['caches']['vertex_array']['hits'] == 1
+    assert stats['caches']['program']['hits'] == 1
+    assert stats['caches']['vertex_array']['size'] >= 1
+    assert stats['bytes_uploaded'] == 8
+    assert stats['bytes_read'] == 16 * 16 * 4
+
+    ctx.reset_stats()
+    stats = ctx.stats()
+    assert stats['draw_calls'] == 0 and stats['gl_calls'] == 0
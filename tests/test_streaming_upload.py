@@ -0,0 +1,56 @@
+import numpy as np
+import pytest
+import zengl
+
+
+def test_write_async(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    for i in range(5):
+        data = np.full((64, 64, 4), i, 'u1')
+        img.write(data, async_=True)
+        assert img.read() == data.tobytes()
+
+    img.write(np.full((2, 2, 4), 255, 'u1'), size=(2, 2), offset=(1, 1), async_=True)
+    assert img.read(size=(1, 1), offset=(1, 1)) == bytes([255, 255, 255, 255])
+
+
+def test_write_not_enough_data(ctx: zengl.Context):
+    img = ctx.image((64, 64), 'rgba8unorm')
+    with pytest.raises(ValueError):
+        img.write(bytes(16))
+
+
+def test_map_unmap(ctx: zengl.Context):
+    img = ctx.image((4, 4), 'rgba8unorm', array=2)
+    mem = img.map(layer=1)
+    mem[:] = bytes(range(64))
+    with pytest.raises(RuntimeError):
+        img.map()
+    img.unmap()
+
+    with pytest.raises(RuntimeError):
+        img.unmap()
+
+    copy = ctx.image((4, 4), 'rgba8unorm')
+    pipeline = ctx.pipeline(
+        vertex_shader='''
+            #version 330
+            void main() {
+                gl_Position = vec4(vec2(gl_VertexID & 1, gl_VertexID >> 1) * 4.0 - 1.0, 0.0, 1.0);
+            }
+        ''',
+        fragment_shader='''
+            #version 330
+            uniform sampler2DArray Texture;
+            layout (location = 0) out vec4 out_color;
+            void main() {
+                out_color = texelFetch(Texture, ivec3(gl_FragCoord.xy, 1), 0);
+            }
+        ''',
+        layout=[{'name': 'Texture', 'binding': 0}],
+        resources=[{'type': 'sampler', 'binding': 0, 'image': img}],
+        framebuffer=[copy],
+        vertex_count=3,
+    )
+    pipeline.render()
+    assert copy.read() == bytes(range(64))
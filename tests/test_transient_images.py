@@ -0,0 +1,94 @@
+import pytest
+import zengl
+
+vertex_shader = '''
+    #version 330
+
+    vec2 positions[3] = vec2[](
+        vec2(-1.0, -1.0),
+        vec2(3.0, -1.0),
+        vec2(-1.0, 3.0)
+    );
+
+    void main() {
+        gl_Position = vec4(positions[gl_VertexID], 0.0, 1.0);
+    }
+'''
+
+fragment_shader = '''
+    #version 330
+
+    layout (location = 0) out vec4 out_color;
+
+    void main() {
+        out_color = vec4(0.0, 1.0, 0.0, 1.0);
+    }
+'''
+
+
+def test_transient_image_reuse(ctx: zengl.Context):
+    a = ctx.transient_image((8, 8), 'rgba8unorm')
+    b = ctx.transient_image((8, 8), 'rgba8unorm')
+    c = ctx.transient_image((8, 8), 'rgba8unorm', samples=4)
+    assert a is not b
+    assert c.samples == 4
+    ctx.end_frame()
+
+    assert ctx.transient_image((8, 8), 'rgba8unorm') in (a, b)
+    assert ctx.transient_image((8, 8), 'rgba8unorm') in (a, b)
+    assert ctx.transient_image((8, 8), 'rgba8unorm', samples=4) is c
+    assert ctx.transient_image((16, 16), 'rgba8unorm') not in (a, b)
+    ctx.end_frame()
+
+    with pytest.raises(ValueError):
+        ctx.release(a)
+
+    ctx.clear_transient_images()
+
+
+def test_transient_image_steady_state(ctx: zengl.Context):
+    memory = ctx.memory()['total']
+    framebuffers = ctx.stats()['caches']['framebuffer']['size']
+
+    def frame():
+        color = ctx.transient_image((4, 4), 'rgba8unorm')
+        depth = ctx.transient_image((4, 4), 'depth24plus')
+        color.clear()
+        depth.clear()
+        pipeline = ctx.pipeline(
+            vertex_shader=vertex_shader,
+            fragment_shader=fragment_shader,
+            framebuffer=[color, depth],
+            vertex_count=3,
+        )
+        pipeline.render()
+        assert color.read() == b'\x00\xff\x00\xff' * 16
+        ctx.release(pipeline)
+        ctx.end_frame()
+
+    frame()
+    stats = ctx.stats()['caches']
+    frame()
+    frame()
+    after = ctx.stats()['caches']
+
+    assert after['transient_image']['misses'] == stats['transient_image']['misses']
+    assert after['transient_image']['hits'] == stats['transient_image']['hits'] + 4
+    assert after['framebuffer']['misses'] == stats['framebuffer']['misses']
+
+    ctx.clear_transient_images()
+    assert ctx.memory()['total'] == memory
+    assert ctx.stats()['caches']['framebuffer']['size'] == framebuffers
+
+
+def test_transient_image_release_keeps_mapping(ctx: zengl.Context):
+    img = ctx.transient_image((4, 4), 'rgba8unorm')
+    mem = img.map()
+    mem[:] = b'\xff' * 64
+
+    with pytest.raises(ValueError):
+        ctx.release(img)
+
+    img.unmap()
+    assert img.read() == b'\xff' * 64
+    ctx.clear_transient_images()
@@ -7,6 +7,19 @@ struct ModuleState {
     PyObject * str_ccw;
     PyObject * float_one;
     PyObject * default_color_mask;
+    PyObject * vertex_format_table;
+    PyObject * image_format_table;
+    PyObject * topology_table;
+    PyObject * front_face_table;
+    PyObject * cull_face_table;
+    PyObject * min_filter_table;
+    PyObject * mag_filter_table;
+    PyObject * texture_wrap_table;
+    PyObject * compare_mode_table;
+    PyObject * compare_func_table;
+    PyObject * blend_constant_table;
+    PyObject * stencil_op_table;
+    PyObject * vertex_step_table;
     PyTypeObject * Context_type;
     PyTypeObject * Buffer_type;
     PyTypeObject * Image_type;
@@ -15,23 +28,35 @@ struct ModuleState {
     PyTypeObject * DescriptorSetImages_type;
     PyTypeObject * GlobalSettings_type;
     PyTypeObject * GLObject_type;
+    PyTypeObject * CommandList_type;
+    PyTypeObject * BufferPool_type;
+    PyTypeObject * BufferSlice_type;
+    PyTypeObject * AsyncRead_type;
+    PyTypeObject * Fence_type;
+    PyTypeObject * RingBuffer_type;
+    PyTypeObject * Query_type;
 };
 
 struct GLObject {
     PyObject_HEAD
+    PyObject * key;
     int uses;
     int obj;
 };
 
 struct DescriptorSetBuffers {
     PyObject_HEAD
+    PyObject * key;
     int uses;
     int buffers;
+    int rings;
     UniformBufferBinding binding[MAX_UNIFORM_BUFFER_BINDINGS];
+    struct Buffer * ring_buffers[MAX_UNIFORM_BUFFER_BINDINGS];
 };
 
 struct DescriptorSetImages {
     PyObject_HEAD
+    PyObject * key;
     int uses;
     int samplers;
     SamplerBinding binding[MAX_SAMPLER_BINDINGS];
@@ -40,6 +65,7 @@ struct DescriptorSetImages {
 
 struct GlobalSettings {
     PyObject_HEAD
+    PyObject * key;
     int uses;
     unsigned long long color_mask;
     int primitive_restart;
@@ -63,6 +89,91 @@ struct GlobalSettings {
     int attachments;
 };
 
+struct GlobalState {
+    unsigned long long color_mask;
+    int blend_enable;
+    int attachments;
+    int primitive_restart;
+    float line_width;
+    int front_face;
+    int cull_face_enable;
+    int cull_face;
+    int depth_test;
+    int depth_write;
+    int depth_func;
+    int stencil_test;
+    StencilSettings stencil_front;
+    StencilSettings stencil_back;
+    int blend_src_color;
+    int blend_dst_color;
+    int blend_src_alpha;
+    int blend_dst_alpha;
+    int polygon_offset;
+    float polygon_offset_factor;
+    float polygon_offset_units;
+};
+
+struct PixelBuffer {
+    int buffer;
+    int size;
+    void * fence;
+    int mapped;
+};
+
+struct DroppedQuery {
+    int query;
+    int target;
+};
+
+struct ImageRegion {
+    IntPair size;
+    IntPair offset;
+    int layer;
+    int level;
+};
+
+struct CacheStats {
+    long long hits;
+    long long misses;
+};
+
+struct ContextStats {
+    long long gl_calls;
+    long long draw_calls;
+    long long vertices;
+    long long instances;
+    long long framebuffer_binds;
+    long long framebuffer_skips;
+    long long program_binds;
+    long long program_skips;
+    long long vertex_array_binds;
+    long long vertex_array_skips;
+    long long global_settings_binds;
+    long long global_settings_skips;
+    long long descriptor_set_binds;
+    long long descriptor_set_skips;
+    long long bytes_uploaded;
+    long long bytes_read;
+    CacheStats descriptor_set_buffers_cache;
+    CacheStats descriptor_set_images_cache;
+    CacheStats global_settings_cache;
+    CacheStats sampler_cache;
+    CacheStats vertex_array_cache;
+    CacheStats framebuffer_cache;
+    CacheStats program_cache;
+    CacheStats shader_cache;
+    CacheStats source_cache;
+    CacheStats program_binary_cache;
+    CacheStats transient_image_pool;
+};
+
+struct ContextMemory {
+    long long buffers;
+    long long images;
+    long long renderbuffers;
+    long long staging;
+};
+
 struct Context {
     PyObject_HEAD
     ModuleState * module_state;
@@ -74,17 +185,50 @@ struct Context {
     PyObject * framebuffer_cache;
     PyObject * program_cache;
     PyObject * shader_cache;
+    PyObject * source_cache;
     PyObject * includes;
     PyObject * info;
     DescriptorSetBuffers * current_buffers;
     DescriptorSetImages * current_images;
     GlobalSettings * current_global_settings;
+    UniformBufferBinding bound_buffers[MAX_UNIFORM_BUFFER_BINDINGS];
+    SamplerBinding bound_images[MAX_SAMPLER_BINDINGS];
+    GlobalState state;
+    int state_valid;
     Viewport viewport;
     int current_framebuffer;
     int current_program;
     int current_vertex_array;
     int default_texture_unit;
+    int active_texture_unit;
     int mapped_buffers;
+    int busy;
+    PyThread_type_lock lock;
+    char * scratch;
+    long long scratch_size;
+    PixelBuffer * pixel_buffers;
+    int pixel_buffer_count;
+    int pixel_buffer_capacity;
+    PixelBuffer unpack_buffers[UNPACK_RING_SIZE];
+    int unpack_index;
+    int read_framebuffer;
+    PyObject * ring_buffers;
+    PyObject * transient_images;
+    PyObject * transient_frame;
+    PyObject * transient_framebuffers;
+    int buffer_storage;
+    int uniform_buffer_alignment;
+    int * query_pool;
+    int query_pool_count;
+    int query_pool_capacity;
+    unsigned active_queries;
+    DroppedQuery dropped_queries[QUERY_SLOTS];
+    PyObject * program_binary_path;
+    int parallel_shader_compile;
+    ContextMemory memory;
+    long long memory_budget;
+    PyObject * memory_hook;
+    ContextStats stats;
     GLMethods gl;
 };
 
@@ -94,6 +238,9 @@ struct Buffer {
     int buffer;
     int size;
     int mapped;
+    int ring;
+    int frame_offset;
+    long long memory;
 };
 
 struct Image {
@@ -111,6 +258,10 @@ struct Image {
     int cubemap;
     int target;
     int renderbuffer;
+    PixelBuffer * mapped_buffer;
+    ImageRegion mapped_region;
+    long long memory;
+    int transient;
 };
 
 struct Pipeline {
@@ -126,95 +277,409 @@ struct Pipeline {
     int vertex_count;
     int instance_count;
     int first_vertex;
+    int base_vertex;
     int index_type;
     int index_size;
+    int layer;
     Viewport viewport;
+    int * profile_queries;
+    int profile_query_count;
+    int profile_query_capacity;
+    long long gpu_time;
+    int gpu_time_count;
+    int released;
+};
+
+struct SortItem {
+    unsigned long long key;
+    int index;
+};
+
+struct BlitParams {
+    Image * target;
+    Viewport target_viewport;
+    Viewport source_viewport;
+    int filter;
+    int srgb;
+};
+
+enum CommandType {
+    COMMAND_RENDER,
+    COMMAND_VIEWPORT,
+    COMMAND_CLEAR,
+    COMMAND_BLIT,
+    COMMAND_WRITE,
+};
+
+struct Command {
+    int type;
+    union {
+        struct {
+            Pipeline * pipeline;
+        } render;
+        struct {
+            Pipeline * pipeline;
+            Viewport viewport;
+            Viewport previous;
+        } viewport;
+        struct {
+            Image * image;
+        } clear;
+        struct {
+            Image * image;
+            BlitParams params;
+        } blit;
+        struct {
+            Buffer * buffer;
+            int offset;
+            int size;
+            void * data;
+        } write;
+    };
+};
+
+struct FreeBlock {
+    int offset;
+    int size;
+};
+
+struct BufferPool {
+    PyObject_HEAD
+    Context * ctx;
+    Buffer * buffer;
+    FreeBlock * blocks;
+    int block_count;
+    int block_capacity;
+    int used;
+};
+
+struct BufferSlice {
+    PyObject_HEAD
+    BufferPool * pool;
+    Buffer * buffer;
+    int offset;
+    int size;
+    int allocated;
+};
+
+struct AsyncRead {
+    PyObject_HEAD
+    Context * ctx;
+    PyObject * result;
+    PixelBuffer pixel_buffer;
+    int size;
 };
 
+struct Fence {
+    PyObject_HEAD
+    Context * ctx;
+    void * sync;
+    int signaled;
+    int released;
+};
+
+struct RingBuffer {
+    PyObject_HEAD
+    Context * ctx;
+    Buffer * buffer;
+    void ** fences;
+    char * ptr;
+    int size;
+    int stride;
+    int frames;
+    int frame;
+    int used;
+    int released;
+};
+
+struct Query {
+    PyObject_HEAD
+    Context * ctx;
+    PyObject * kind;
+    int query;
+    int target;
+    int active;
+    int issued;
+};
+
+struct CommandList {
+    PyObject_HEAD
+    Context * ctx;
+    PyObject * objects;
+    Command * commands;
+    Py_buffer * views;
+    int count;
+    int capacity;
+    int view_count;
+    int view_capacity;
+};
+
+void wait_context(Context * self) {
+    while (self->busy) {
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(self->lock, WAIT_LOCK);
+        PyThread_release_lock(self->lock);
+        Py_END_ALLOW_THREADS
+    }
+}
+
+PyThreadState * release_context(Context * self) {
+    wait_context(self);
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    self->busy = true;
+    return PyEval_SaveThread();
+}
+
+PyThreadState * begin_allow_threads(Context * self, long long size) {
+    if (size < MIN_ALLOW_THREADS_SIZE) {
+        return NULL;
+    }
+    return release_context(self);
+}
+
+void end_allow_threads(Context * self, PyThreadState * state) {
+    if (state) {
+        PyEval_RestoreThread(state);
+        self->busy = false;
+        PyThread_release_lock(self->lock);
+    }
+}
+
+void bind_uniform_buffer(Context * self, int index, const UniformBufferBinding & binding) {
+    UniformBufferBinding & bound = self->bound_buffers[index];
+    if (bound.buffer != binding.buffer || bound.offset != binding.offset || bound.size != binding.size) {
+        self->gl.BindBufferRange(GL_UNIFORM_BUFFER, index, binding.buffer, binding.offset, binding.size);
+        self->stats.gl_calls += 1;
+        bound = binding;
+    }
+}
+
+void bind_texture(Context * self, int unit, int target, int image) {
+    if (self->active_texture_unit != GL_TEXTURE0 + unit) {
+        self->active_texture_unit = GL_TEXTURE0 + unit;
+        self->gl.ActiveTexture(GL_TEXTURE0 + unit);
+        self->stats.gl_calls += 1;
+    }
+    self->gl.BindTexture(target, image);
+    self->stats.gl_calls += 1;
+}
+
+void bind_sampler_binding(Context * self, int index, const SamplerBinding & binding) {
+    SamplerBinding & bound = self->bound_images[index];
+    if (bound.target != binding.target || bound.image != binding.image) {
+        bind_texture(self, index, binding.target, binding.image);
+        bound.target = binding.target;
+        bound.image = binding.image;
+    }
+    if (bound.sampler != binding.sampler) {
+        self->gl.BindSampler(index, binding.sampler);
+        bound.sampler = binding.sampler;
+    }
+}
+
+void bind_default_texture(Context * self, int target, int image) {
+    const int unit = self->default_texture_unit - GL_TEXTURE0;
+    if (unit < MAX_SAMPLER_BINDINGS) {
+        SamplerBinding & bound = self->bound_images[unit];
+        if (bound.target == target && bound.image == image && self->active_texture_unit == self->default_texture_unit) {
+            return;
+        }
+        bound.target = target;
+        bound.image = image;
+        if (self->current_images && unit < self->current_images->samplers) {
+            self->current_images = NULL;
+        }
+    }
+    bind_texture(self, unit, target, image);
+}
+
 void bind_descriptor_set_buffers(Context * self, DescriptorSetBuffers * set) {
-    const GLMethods & gl = self->gl;
-    if (self->current_buffers != set) {
+    if (self->current_buffers != set || set->rings) {
+        self->stats.descriptor_set_binds += 1;
         self->current_buffers = set;
         for (int i = 0; i < set->buffers; ++i) {
-            gl.BindBufferRange(
-                GL_UNIFORM_BUFFER,
-                i,
-                set->binding[i].buffer,
-                set->binding[i].offset,
-                set->binding[i].size
-            );
+            if (set->ring_buffers[i]) {
+                UniformBufferBinding binding = set->binding[i];
+                binding.offset += set->ring_buffers[i]->frame_offset;
+                bind_uniform_buffer(self, i, binding);
+            } else if (set->binding[i].buffer) {
+                bind_uniform_buffer(self, i, set->binding[i]);
+            }
         }
+    } else {
+        self->stats.descriptor_set_skips += 1;
     }
 }
 
 void bind_descriptor_set_images(Context * self, DescriptorSetImages * set) {
-    const GLMethods & gl = self->gl;
     if (self->current_images != set) {
+        self->stats.descriptor_set_binds += 1;
         self->current_images = set;
         for (int i = 0; i < set->samplers; ++i) {
-            gl.ActiveTexture(GL_TEXTURE0 + i);
-            gl.BindTexture(set->binding[i].target, set->binding[i].image);
-            gl.BindSampler(i, set->binding[i].sampler);
+            if (set->binding[i].target) {
+                bind_sampler_binding(self, i, set->binding[i]);
+            }
         }
+    } else {
+        self->stats.descriptor_set_skips += 1;
+    }
+}
+
+void set_enabled(Context * self, int cap, int enable) {
+    if (enable) {
+        self->gl.Enable(cap);
+    } else {
+        self->gl.Disable(cap);
+    }
+}
+
+void set_color_mask(Context * self, int attachment, int mask) {
+    GlobalState & state = self->state;
+    const int shift = attachment * 4;
+    const bool known = self->state_valid && attachment < state.attachments;
+    if (!known || (state.color_mask >> shift & 0xf) != (unsigned long long)mask) {
+        self->gl.ColorMaski(attachment, mask & 1, mask >> 1 & 1, mask >> 2 & 1, mask >> 3 & 1);
+        state.color_mask = (state.color_mask & ~(0xfull << shift)) | ((unsigned long long)mask << shift);
+    }
+}
+
+void set_depth_write(Context * self, int depth_write) {
+    if (!self->state_valid || self->state.depth_write != depth_write) {
+        self->gl.DepthMask(depth_write);
+        self->state.depth_write = depth_write;
+    }
+}
+
+void set_stencil_write_mask(Context * self, int write_mask) {
+    if (!self->state_valid || self->state.stencil_front.write_mask != write_mask) {
+        self->gl.StencilMaskSeparate(GL_FRONT, write_mask);
+        self->state.stencil_front.write_mask = write_mask;
     }
 }
 
 void bind_global_settings(Context * self, GlobalSettings * settings) {
+    if (self->current_global_settings == settings) {
+        self->stats.global_settings_skips += 1;
+        return;
+    }
+
+    self->stats.global_settings_binds += 1;
+
     const GLMethods & gl = self->gl;
-    if (settings->primitive_restart) {
-        gl.Enable(GL_PRIMITIVE_RESTART);
-    } else {
-        gl.Disable(GL_PRIMITIVE_RESTART);
+    GlobalState & state = self->state;
+    const bool all = !self->state_valid;
+
+    self->current_global_settings = settings;
+
+    if (all || state.primitive_restart != settings->primitive_restart) {
+        set_enabled(self, GL_PRIMITIVE_RESTART, settings->primitive_restart);
+        state.primitive_restart = settings->primitive_restart;
     }
-    if (settings->polygon_offset) {
-        gl.Enable(GL_POLYGON_OFFSET_FILL);
-        gl.Enable(GL_POLYGON_OFFSET_LINE);
-        gl.Enable(GL_POLYGON_OFFSET_POINT);
-    } else {
-        gl.Disable(GL_POLYGON_OFFSET_FILL);
-        gl.Disable(GL_POLYGON_OFFSET_LINE);
-        gl.Disable(GL_POLYGON_OFFSET_POINT);
+    if (all || state.polygon_offset != settings->polygon_offset) {
+        set_enabled(self, GL_POLYGON_OFFSET_FILL, settings->polygon_offset);
+        set_enabled(self, GL_POLYGON_OFFSET_LINE, settings->polygon_offset);
+        set_enabled(self, GL_POLYGON_OFFSET_POINT, settings->polygon_offset);
+        state.polygon_offset = settings->polygon_offset;
     }
-    if (settings->stencil_test) {
-        gl.Enable(GL_STENCIL_TEST);
-    } else {
-        gl.Disable(GL_STENCIL_TEST);
+    if (all || state.stencil_test != settings->stencil_test) {
+        set_enabled(self, GL_STENCIL_TEST, settings->stencil_test);
+        state.stencil_test = settings->stencil_test;
     }
-    if (settings->depth_test) {
-        gl.Enable(GL_DEPTH_TEST);
-    } else {
-        gl.Disable(GL_DEPTH_TEST);
+    if (all || state.depth_test != settings->depth_test) {
+        set_enabled(self, GL_DEPTH_TEST, settings->depth_test);
+        state.depth_test = settings->depth_test;
     }
-    if (settings->cull_face) {
-        gl.Enable(GL_CULL_FACE);
+    if (all || state.cull_face_enable != (settings->cull_face != 0)) {
+        set_enabled(self, GL_CULL_FACE, settings->cull_face != 0);
+        state.cull_face_enable = settings->cull_face != 0;
+    }
+    if (settings->cull_face && (all || state.cull_face != settings->cull_face)) {
         gl.CullFace(settings->cull_face);
-    } else {
-        gl.Disable(GL_CULL_FACE);
-    }
-    gl.LineWidth(settings->line_width);
-    gl.FrontFace(settings->front_face);
-    gl.DepthMask(settings->depth_write);
-    gl.StencilMaskSeparate(GL_FRONT, settings->stencil_front.write_mask);
-    gl.StencilMaskSeparate(GL_BACK, settings->stencil_back.write_mask);
-    gl.StencilFuncSeparate(GL_FRONT, settings->stencil_front.compare_op, settings->stencil_front.reference, settings->stencil_front.compare_mask);
-    gl.StencilFuncSeparate(GL_BACK, settings->stencil_back.compare_op, settings->stencil_back.reference, settings->stencil_back.compare_mask);
-    gl.StencilOpSeparate(GL_FRONT, settings->stencil_front.fail_op, settings->stencil_front.pass_op, settings->stencil_front.depth_fail_op);
-    gl.StencilOpSeparate(GL_BACK, settings->stencil_back.fail_op, settings->stencil_back.pass_op, settings->stencil_back.depth_fail_op);
-    gl.BlendFuncSeparate(settings->blend_src_color, settings->blend_dst_color, settings->blend_src_alpha, settings->blend_dst_alpha);
-    gl.PolygonOffset(settings->polygon_offset_factor, settings->polygon_offset_units);
+        state.cull_face = settings->cull_face;
+    }
+    if (all || state.line_width != settings->line_width) {
+        gl.LineWidth(settings->line_width);
+        state.line_width = settings->line_width;
+    }
+    if (all || state.front_face != settings->front_face) {
+        gl.FrontFace(settings->front_face);
+        state.front_face = settings->front_face;
+    }
+    set_depth_write(self, settings->depth_write);
+    if (all || state.depth_func != settings->depth_func) {
+        gl.DepthFunc(settings->depth_func);
+        state.depth_func = settings->depth_func;
+    }
+    set_stencil_write_mask(self, settings->stencil_front.write_mask);
+    if (all || state.stencil_back.write_mask != settings->stencil_back.write_mask) {
+        gl.StencilMaskSeparate(GL_BACK, settings->stencil_back.write_mask);
+        state.stencil_back.write_mask = settings->stencil_back.write_mask;
+    }
+    const StencilSettings & front = settings->stencil_front;
+    const StencilSettings & back = settings->stencil_back;
+    if (all || state.stencil_front.compare_op != front.compare_op || state.stencil_front.reference != front.reference || state.stencil_front.compare_mask != front.compare_mask) {
+        gl.StencilFuncSeparate(GL_FRONT, front.compare_op, front.reference, front.compare_mask);
+        state.stencil_front.compare_op = front.compare_op;
+        state.stencil_front.reference = front.reference;
+        state.stencil_front.compare_mask = front.compare_mask;
+    }
+    if (all || state.stencil_back.compare_op != back.compare_op || state.stencil_back.reference != back.reference || state.stencil_back.compare_mask != back.compare_mask) {
+        gl.StencilFuncSeparate(GL_BACK, back.compare_op, back.reference, back.compare_mask);
+        state.stencil_back.compare_op = back.compare_op;
+        state.stencil_back.reference = back.reference;
+        state.stencil_back.compare_mask = back.compare_mask;
+    }
+    if (all || state.stencil_front.fail_op != front.fail_op || state.stencil_front.pass_op != front.pass_op || state.stencil_front.depth_fail_op != front.depth_fail_op) {
+        gl.StencilOpSeparate(GL_FRONT, front.fail_op, front.pass_op, front.depth_fail_op);
+        state.stencil_front.fail_op = front.fail_op;
+        state.stencil_front.pass_op = front.pass_op;
+        state.stencil_front.depth_fail_op = front.depth_fail_op;
+    }
+    if (all || state.stencil_back.fail_op != back.fail_op || state.stencil_back.pass_op != back.pass_op || state.stencil_back.depth_fail_op != back.depth_fail_op) {
+        gl.StencilOpSeparate(GL_BACK, back.fail_op, back.pass_op, back.depth_fail_op);
+        state.stencil_back.fail_op = back.fail_op;
+        state.stencil_back.pass_op = back.pass_op;
+        state.stencil_back.depth_fail_op = back.depth_fail_op;
+    }
+    const bool blend_func_changed = (
+        state.blend_src_color != settings->blend_src_color || state.blend_dst_color != settings->blend_dst_color ||
+        state.blend_src_alpha != settings->blend_src_alpha || state.blend_dst_alpha != settings->blend_dst_alpha
+    );
+    if (all || blend_func_changed) {
+        gl.BlendFuncSeparate(settings->blend_src_color, settings->blend_dst_color, settings->blend_src_alpha, settings->blend_dst_alpha);
+        state.blend_src_color = settings->blend_src_color;
+        state.blend_dst_color = settings->blend_dst_color;
+        state.blend_src_alpha = settings->blend_src_alpha;
+        state.blend_dst_alpha = settings->blend_dst_alpha;
+    }
+    if (all || state.polygon_offset_factor != settings->polygon_offset_factor || state.polygon_offset_units != settings->polygon_offset_units) {
+        gl.PolygonOffset(settings->polygon_offset_factor, settings->polygon_offset_units);
+        state.polygon_offset_factor = settings->polygon_offset_factor;
+        state.polygon_offset_units = settings->polygon_offset_units;
+    }
     for (int i = 0; i < settings->attachments; ++i) {
-        if (settings->blend_enable >> i & 1) {
-            gl.Enablei(GL_BLEND, i);
-        } else {
-            gl.Disablei(GL_BLEND, i);
-        }
-        gl.ColorMaski(
-            i,
-            settings->color_mask >> (i * 4 + 0) & 1,
-            settings->color_mask >> (i * 4 + 1) & 1,
-            settings->color_mask >> (i * 4 + 2) & 1,
-            settings->color_mask >> (i * 4 + 3) & 1
-        );
+        const int blend = settings->blend_enable >> i & 1;
+        if (all || i >= state.attachments || (state.blend_enable >> i & 1) != blend) {
+            if (blend) {
+                gl.Enablei(GL_BLEND, i);
+            } else {
+                gl.Disablei(GL_BLEND, i);
+            }
+            state.blend_enable = (state.blend_enable & ~(1 << i)) | (blend << i);
+        }
+        set_color_mask(self, i, settings->color_mask >> (i * 4) & 0xf);
+    }
+    if (all || state.attachments < settings->attachments) {
+        state.attachments = settings->attachments;
+    }
+    self->state_valid = true;
+}
+
+void bind_viewport(Context * self, Viewport viewport) {
+    if (self->viewport.viewport != viewport.viewport) {
+        self->viewport = viewport;
+        self->gl.Viewport(viewport.x, viewport.y, viewport.width, viewport.height);
+        self->stats.gl_calls += 1;
     }
 }
 
@@ -222,6 +687,10 @@ void bind_framebuffer(Context * self, int framebuffer) {
     if (self->current_framebuffer != framebuffer) {
         self->current_framebuffer = framebuffer;
         self->gl.BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        self->stats.framebuffer_binds += 1;
+        self->stats.gl_calls += 1;
+    } else {
+        self->stats.framebuffer_skips += 1;
     }
 }
 
@@ -229,6 +698,10 @@ void bind_program(Context * self, int program) {
     if (self->current_program != program) {
         self->current_program = program;
         self->gl.UseProgram(program);
+        self->stats.program_binds += 1;
+        self->stats.gl_calls += 1;
+    } else {
+        self->stats.program_skips += 1;
     }
 }
 
@@ -236,15 +709,53 @@ void bind_vertex_array(Context * self, int vertex_array) {
     if (self->current_vertex_array != vertex_array) {
         self->current_vertex_array = vertex_array;
         self->gl.BindVertexArray(vertex_array);
+        self->stats.vertex_array_binds += 1;
+        self->stats.gl_calls += 1;
+    } else {
+        self->stats.vertex_array_skips += 1;
+    }
+}
+
+void bind_pipeline(Pipeline * self) {
+    bind_viewport(self->ctx, self->viewport);
+    bind_global_settings(self->ctx, self->global_settings);
+    bind_framebuffer(self->ctx, self->framebuffer->obj);
+    bind_program(self->ctx, self->program->obj);
+    bind_vertex_array(self->ctx, self->vertex_array->obj);
+    bind_descriptor_set_buffers(self->ctx, self->descriptor_set_buffers);
+    bind_descriptor_set_images(self->ctx, self->descriptor_set_images);
+}
+
+void count_draws(Context * self, long long draw_calls, long long vertices, long long instances) {
+    self->stats.gl_calls += draw_calls;
+    self->stats.draw_calls += draw_calls;
+    self->stats.vertices += vertices;
+    self->stats.instances += instances;
+}
+
+void render_pipeline(Pipeline * self) {
+    const GLMethods & gl = self->ctx->gl;
+    bind_pipeline(self);
+    count_draws(self->ctx, 1, (long long)self->vertex_count * self->instance_count, self->instance_count);
+    if (self->index_type && self->base_vertex) {
+        long long offset = (long long)self->first_vertex * self->index_size;
+        gl.DrawElementsInstancedBaseVertex(self->topology, self->vertex_count, self->index_type, (void *)offset, self->instance_count, self->base_vertex);
+    } else if (self->index_type) {
+        long long offset = (long long)self->first_vertex * self->index_size;
+        gl.DrawElementsInstanced(self->topology, self->vertex_count, self->index_type, (void *)offset, self->instance_count);
+    } else {
+        gl.DrawArraysInstanced(self->topology, self->first_vertex + self->base_vertex, self->vertex_count, self->instance_count);
     }
 }
 
 GLObject * build_framebuffer(Context * self, PyObject * attachments) {
     if (GLObject * cache = (GLObject *)PyDict_GetItem(self->framebuffer_cache, attachments)) {
+        self->stats.framebuffer_cache.hits += 1;
         cache->uses += 1;
         Py_INCREF(cache);
         return cache;
     }
+    self->stats.framebuffer_cache.misses += 1;
 
     PyObject * color_attachments = PyTuple_GetItem(attachments, 0);
     PyObject * depth_stencil_attachment = PyTuple_GetItem(attachments, 1);
@@ -287,16 +798,19 @@ GLObject * build_framebuffer(Context * self, PyObject * attachments) {
     res->obj = framebuffer;
     res->uses = 1;
 
+    res->key = (PyObject *)new_ref(attachments);
     PyDict_SetItem(self->framebuffer_cache, attachments, (PyObject *)res);
     return res;
 }
 
 GLObject * build_vertex_array(Context * self, PyObject * bindings) {
-    if (GLObject * cache = (GLObject *)PyDict_GetItem(self->framebuffer_cache, bindings)) {
+    if (GLObject * cache = (GLObject *)PyDict_GetItem(self->vertex_array_cache, bindings)) {
+        self->stats.vertex_array_cache.hits += 1;
         cache->uses += 1;
         Py_INCREF(cache);
         return cache;
     }
+    self->stats.vertex_array_cache.misses += 1;
 
     const GLMethods & gl = self->gl;
 
@@ -314,7 +828,7 @@ GLObject * build_vertex_array(Context * self, PyObject * bindings) {
         void * offset = PyLong_AsVoidPtr(seq[i + 2]);
         int stride = PyLong_AsLong(seq[i + 3]);
         int divisor = PyLong_AsLong(seq[i + 4]);
-        VertexFormat format = get_vertex_format(PyUnicode_AsUTF8(seq[i + 5]));
+        VertexFormat format = vertex_formats[PyLong_AsLong(PyDict_GetItem(self->module_state->vertex_format_table, seq[i + 5]))].format;
         gl.BindBuffer(GL_ARRAY_BUFFER, buffer->buffer);
         if (format.integer) {
             gl.VertexAttribIPointer(location, format.size, format.type, stride, offset);
@@ -334,16 +848,19 @@ GLObject * build_vertex_array(Context * self, PyObject * bindings) {
     res->obj = vertex_array;
     res->uses = 1;
 
+    res->key = (PyObject *)new_ref(bindings);
     PyDict_SetItem(self->vertex_array_cache, bindings, (PyObject *)res);
     return res;
 }
 
 GLObject * build_sampler(Context * self, PyObject * params) {
     if (GLObject * cache = (GLObject *)PyDict_GetItem(self->sampler_cache, params)) {
+        self->stats.sampler_cache.hits += 1;
         cache->uses += 1;
         Py_INCREF(cache);
         return cache;
     }
+    self->stats.sampler_cache.misses += 1;
 
     const GLMethods & gl = self->gl;
 
@@ -374,23 +891,28 @@ GLObject * build_sampler(Context * self, PyObject * params) {
     res->obj = sampler;
     res->uses = 1;
 
+    res->key = (PyObject *)new_ref(params);
     PyDict_SetItem(self->sampler_cache, params, (PyObject *)res);
     return res;
 }
 
 DescriptorSetBuffers * build_descriptor_set_buffers(Context * self, PyObject * bindings) {
     if (DescriptorSetBuffers * cache = (DescriptorSetBuffers *)PyDict_GetItem(self->descriptor_set_buffers_cache, bindings)) {
+        self->stats.descriptor_set_buffers_cache.hits += 1;
         cache->uses += 1;
         Py_INCREF(cache);
         return cache;
     }
+    self->stats.descriptor_set_buffers_cache.misses += 1;
 
     int length = (int)PyTuple_Size(bindings);
     PyObject ** seq = PySequence_Fast_ITEMS(bindings);
 
     DescriptorSetBuffers * res = PyObject_New(DescriptorSetBuffers, self->module_state->DescriptorSetBuffers_type);
     memset(res->binding, 0, sizeof(res->binding));
+    memset(res->ring_buffers, 0, sizeof(res->ring_buffers));
     res->buffers = 0;
+    res->rings = 0;
     res->uses = 1;
 
     for (int i = 0; i < length; i += 4) {
@@ -399,19 +921,26 @@ DescriptorSetBuffers * build_descriptor_set_buffers(Context * self, PyObject * b
         int offset = PyLong_AsLong(seq[i + 2]);
         int size = PyLong_AsLong(seq[i + 3]);
         res->binding[binding] = {buffer->buffer, offset, size};
+        if (buffer->ring) {
+            res->ring_buffers[binding] = buffer;
+            res->rings += 1;
+        }
         res->buffers = res->buffers > (binding + 1) ? res->buffers : (binding + 1);
     }
 
+    res->key = (PyObject *)new_ref(bindings);
     PyDict_SetItem(self->descriptor_set_buffers_cache, bindings, (PyObject *)res);
     return res;
 }
 
 DescriptorSetImages * build_descriptor_set_images(Context * self, PyObject * bindings) {
     if (DescriptorSetImages * cache = (DescriptorSetImages *)PyDict_GetItem(self->descriptor_set_images_cache, bindings)) {
+        self->stats.descriptor_set_images_cache.hits += 1;
         cache->uses += 1;
         Py_INCREF(cache);
         return cache;
     }
+    self->stats.descriptor_set_images_cache.misses += 1;
 
     int length = (int)PyTuple_Size(bindings);
     PyObject ** seq = PySequence_Fast_ITEMS(bindings);
@@ -429,16 +958,19 @@ DescriptorSetImages * build_descriptor_set_images(Context * self, PyObject * bin
         res->samplers = res->samplers > (binding + 1) ? res->samplers : (binding + 1);
     }
 
+    res->key = (PyObject *)new_ref(bindings);
     PyDict_SetItem(self->descriptor_set_images_cache, bindings, (PyObject *)res);
     return res;
 }
 
 GlobalSettings * build_global_settings(Context * self, PyObject * settings) {
     if (GlobalSettings * cache = (GlobalSettings *)PyDict_GetItem(self->global_settings_cache, settings)) {
+        self->stats.global_settings_cache.hits += 1;
         cache->uses += 1;
         Py_INCREF(cache);
         return cache;
     }
+    self->stats.global_settings_cache.misses += 1;
 
     PyObject ** seq = PySequence_Fast_ITEMS(settings);
 
@@ -482,16 +1014,19 @@ GlobalSettings * build_global_settings(Context * self, PyObject * settings) {
     res->polygon_offset_units = (float)PyFloat_AsDouble(seq[30]);
     res->attachments = PyLong_AsLong(seq[31]);
 
+    res->key = (PyObject *)new_ref(settings);
     PyDict_SetItem(self->global_settings_cache, settings, (PyObject *)res);
     return res;
 }
 
-GLObject * compile_shader(Context * self, PyObject * code, int type, const char * name) {
+GLObject * issue_shader(Context * self, PyObject * code, int type) {
     if (GLObject * cache = (GLObject *)PyDict_GetItem(self->shader_cache, code)) {
+        self->stats.shader_cache.hits += 1;
         cache->uses += 1;
         Py_INCREF(cache);
         return cache;
     }
+    self->stats.shader_cache.misses += 1;
 
     const GLMethods & gl = self->gl;
 
@@ -500,124 +1035,719 @@ GLObject * compile_shader(Context * self, PyObject * code, int type, const char
     gl.ShaderSource(shader, 1, &src, 0);
     gl.CompileShader(shader);
 
+    GLObject * res = PyObject_New(GLObject, self->module_state->GLObject_type);
+    res->obj = shader;
+    res->uses = 1;
+
+    res->key = (PyObject *)new_ref(code);
+    PyDict_SetItem(self->shader_cache, code, (PyObject *)res);
+    return res;
+}
+
+bool check_shader(Context * self, GLObject * shader, const char * name) {
+    const GLMethods & gl = self->gl;
+
     int shader_compiled = false;
-    gl.GetShaderiv(shader, GL_COMPILE_STATUS, &shader_compiled);
+    gl.GetShaderiv(shader->obj, GL_COMPILE_STATUS, &shader_compiled);
 
     if (!shader_compiled) {
         int log_size = 0;
-        gl.GetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_size);
+        gl.GetShaderiv(shader->obj, GL_INFO_LOG_LENGTH, &log_size);
         char * log_text = (char *)malloc(log_size + 1);
-        gl.GetShaderInfoLog(shader, log_size, &log_size, log_text);
+        gl.GetShaderInfoLog(shader->obj, log_size, &log_size, log_text);
         log_text[log_size] = 0;
         PyErr_Format(PyExc_ValueError, "%s Error\n\n%s", name, log_text);
         free(log_text);
-        return 0;
+        if (shader->key) {
+            gl.DeleteShader(shader->obj);
+            remove_dict_key(self->shader_cache, &shader->key);
+        }
+        return false;
     }
 
-    GLObject * res = PyObject_New(GLObject, self->module_state->GLObject_type);
-    res->obj = shader;
-    res->uses = 1;
-
-    PyDict_SetItem(self->shader_cache, code, (PyObject *)res);
-    return res;
+    return true;
 }
 
-GLObject * compile_program(Context * self, PyObject * vert, PyObject * frag, PyObject * layout) {
-    const GLMethods & gl = self->gl;
+const unsigned PROGRAM_BINARY_MAGIC = 0x42504c5a;
 
-    PyObject * pair = PyObject_CallMethod(self->module_state->helper, "program", "OOOO", vert, frag, layout, self->includes);
-    if (!pair) {
-        return NULL;
-    }
+struct ProgramBinaryKey {
+    unsigned long long hash;
+    unsigned long long check;
+    long long source_length;
+};
 
-    if (GLObject * cache = (GLObject *)PyDict_GetItem(self->program_cache, pair)) {
-        cache->uses += 1;
-        Py_INCREF(cache);
-        return cache;
+struct ProgramBinaryHeader {
+    unsigned magic;
+    unsigned format;
+    ProgramBinaryKey key;
+    long long length;
+};
+
+void hash_bytes(ProgramBinaryKey * key, const void * data, long long size) {
+    const unsigned char * ptr = (const unsigned char *)data;
+    for (long long i = 0; i < size; ++i) {
+        key->hash = (key->hash ^ ptr[i]) * 0x100000001b3ull;
+        key->check = (key->check + ptr[i]) * 0x9e3779b97f4a7c15ull;
+        key->check ^= key->check >> 29;
     }
+    key->source_length += size;
+}
 
-    PyObject * vert_code = PyTuple_GetItem(pair, 0);
-    PyObject * frag_code = PyTuple_GetItem(pair, 1);
+void hash_object(ProgramBinaryKey * key, PyObject * obj) {
+    Py_ssize_t size = 0;
+    const char * data = NULL;
+    long long value = 0;
+    if (PyBytes_Check(obj)) {
+        size = PyBytes_GET_SIZE(obj);
+        data = PyBytes_AS_STRING(obj);
+    } else if (PyUnicode_Check(obj)) {
+        data = PyUnicode_AsUTF8AndSize(obj, &size);
+    } else {
+        value = PyLong_AsLongLong(obj);
+        size = sizeof(value);
+        data = (const char *)&value;
+    }
+    hash_bytes(key, &size, sizeof(size));
+    hash_bytes(key, data, size);
+}
 
-    GLObject * vertex_shader = compile_shader(self, vert_code, GL_VERTEX_SHADER, "Vertex Shader");
-    if (!vertex_shader) {
-        Py_DECREF(pair);
-        return NULL;
+char * program_binary_path(Context * self, PyObject * pair, ProgramBinaryKey * key) {
+    *key = {0xcbf29ce484222325ull, 0x84222325cbf29ce4ull, 0};
+    hash_object(key, PyTuple_GetItem(pair, 0));
+    hash_object(key, PyTuple_GetItem(pair, 1));
+    PyObject * bindings = PyTuple_GetItem(pair, 2);
+    for (int i = 0; i < (int)PyTuple_Size(bindings); ++i) {
+        hash_object(key, PyTuple_GetItem(bindings, i));
+    }
+    for (int i = 0; i < 3; ++i) {
+        hash_object(key, PyTuple_GetItem(self->info, i));
     }
-    int vertex_shader_obj = vertex_shader->obj;
-    Py_DECREF(vertex_shader);
 
-    GLObject * fragment_shader = compile_shader(self, frag_code, GL_FRAGMENT_SHADER, "Fragment Shader");
-    if (!fragment_shader) {
-        Py_DECREF(pair);
+    if (PyErr_Occurred()) {
+        PyErr_Clear();
         return NULL;
     }
-    int fragment_shader_obj = fragment_shader->obj;
-    Py_DECREF(fragment_shader);
 
-    int program = gl.CreateProgram();
-    gl.AttachShader(program, vertex_shader_obj);
-    gl.AttachShader(program, fragment_shader_obj);
-    gl.LinkProgram(program);
+    const char * directory = PyBytes_AsString(self->program_binary_path);
+    const int size = (int)strlen(directory) + 32;
+    char * res = (char *)malloc(size);
+    snprintf(res, size, "%s/%016llx.bin", directory, key->hash);
+    return res;
+}
 
-    int linked = false;
-    gl.GetProgramiv(program, GL_LINK_STATUS, &linked);
+int load_program_binary(Context * self, const char * path, const ProgramBinaryKey & key) {
+    const GLMethods & gl = self->gl;
 
-    if (!linked) {
-        int log_size = 0;
-        gl.GetProgramiv(program, GL_INFO_LOG_LENGTH, &log_size);
-        char * log_text = (char *)malloc(log_size + 1);
-        gl.GetProgramInfoLog(program, log_size, &log_size, log_text);
-        log_text[log_size] = 0;
-        Py_DECREF(pair);
-        PyErr_Format(PyExc_ValueError, "Linker Error\n\n%s", log_text);
-        free(log_text);
+    FILE * file = fopen(path, "rb");
+    if (!file) {
         return 0;
     }
 
-    GLObject * res = PyObject_New(GLObject, self->module_state->GLObject_type);
-    res->obj = program;
-    res->uses = 1;
+    ProgramBinaryHeader header = {};
+    void * data = NULL;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1;
+    valid = valid && header.magic == PROGRAM_BINARY_MAGIC && header.length > 0 && header.length < 0x40000000;
+    valid = valid && header.key.hash == key.hash && header.key.check == key.check && header.key.source_length == key.source_length;
+    if (valid) {
+        data = malloc(header.length);
+        valid = fread(data, 1, header.length, file) == (size_t)header.length;
+    }
+    fclose(file);
+
+    int program = 0;
+    if (valid) {
+        program = gl.CreateProgram();
+        gl.ProgramBinary(program, header.format, data, (int)header.length);
+        int linked = false;
+        gl.GetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            gl.DeleteProgram(program);
+            program = 0;
+        }
+    }
 
-    PyDict_SetItem(self->program_cache, pair, (PyObject *)res);
-    Py_DECREF(pair);
-    return res;
+    free(data);
+    return program;
 }
 
-Context * meth_context(PyObject * self, PyObject * vargs, PyObject * kwargs) {
-    static char * keywords[] = {"loader", NULL};
-
-    PyObject * loader = Py_None;
+void save_program_binary(Context * self, const char * path, const ProgramBinaryKey & key, int program) {
+    const GLMethods & gl = self->gl;
 
-    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "|O", keywords, &loader)) {
-        return NULL;
+    int length = 0;
+    gl.GetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
     }
 
-    ModuleState * module_state = (ModuleState *)PyModule_GetState(self);
-
-    if (loader == Py_None) {
-        loader = PyObject_CallMethod(module_state->helper, "loader", NULL);
-        if (!loader) {
-            return NULL;
+    ProgramBinaryHeader header = {PROGRAM_BINARY_MAGIC, 0, key, 0};
+    void * data = malloc(length);
+    gl.GetProgramBinary(program, length, &length, &header.format, data);
+    header.length = length;
+
+    const int temp_size = (int)strlen(path) + 8;
+    char * temp_path = (char *)malloc(temp_size);
+    snprintf(temp_path, temp_size, "%s.tmp", path);
+
+    if (FILE * file = fopen(temp_path, "wb")) {
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(data, 1, length, file) == (size_t)length;
+        written = !fclose(file) && written;
+        if (written && rename(temp_path, path)) {
+            remove(path);
+            written = !rename(temp_path, path);
+        }
+        if (!written) {
+            remove(temp_path);
         }
-    } else {
-        Py_INCREF(loader);
     }
 
-    GLMethods gl = load_gl(loader);
-    Py_DECREF(loader);
+    free(temp_path);
+    free(data);
+}
 
-    if (PyErr_Occurred()) {
-        return NULL;
-    }
+struct ProgramBuild {
+    PyObject * key;
+    GLObject * program;
+    GLObject * vertex_shader;
+    GLObject * fragment_shader;
+    char * binary_path;
+    ProgramBinaryKey binary_key;
+};
 
-    int max_texture_image_units = 0;
-    gl.GetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_texture_image_units);
-    int default_texture_unit = GL_TEXTURE0 + max_texture_image_units - 1;
+const int MAX_INCLUDE_DEPTH = 16;
+
+struct ShaderSource {
+    char * data;
+    int size;
+    int capacity;
+};
+
+void append_source(ShaderSource * self, const char * text, int size) {
+    if (self->capacity < self->size + size) {
+        self->capacity = (self->size + size) * 2 + 256;
+        self->data = (char *)realloc(self->data, self->capacity);
+    }
+    for (int i = 0; i < size; ++i) {
+        if (text[i] != '\r') {
+            self->data[self->size++] = text[i];
+        }
+    }
+}
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool is_blank_line(const char * line, int size) {
+    for (int i = 0; i < size; ++i) {
+        if (line[i] != ' ' && line[i] != '\t') {
+            return false;
+        }
+    }
+    return true;
+}
+
+int line_length(const char * text, int size) {
+    const char * end = (const char *)memchr(text, '\n', size);
+    return end ? (int)(end - text) : size;
+}
+
+char * dedent_source(const char * text, int size, int * res_size) {
+    const char * margin = NULL;
+    int margin_size = 0;
+    for (int i = 0; i <= size; ++i) {
+        const int length = line_length(text + i, size - i);
+        if (!is_blank_line(text + i, length)) {
+            int indent = 0;
+            while (text[i + indent] == ' ' || text[i + indent] == '\t') {
+                indent += 1;
+            }
+            if (!margin) {
+                margin = text + i;
+                margin_size = indent;
+            }
+            int common = 0;
+            while (common < margin_size && common < indent && margin[common] == text[i + common]) {
+                common += 1;
+            }
+            margin_size = common;
+        }
+        i += length;
+    }
+
+    char * res = (char *)malloc(size + 1);
+    int res_length = 0;
+    for (int i = 0; i <= size; ++i) {
+        const int length = line_length(text + i, size - i);
+        if (!is_blank_line(text + i, length)) {
+            memcpy(res + res_length, text + i + margin_size, length - margin_size);
+            res_length += length - margin_size;
+        }
+        if (i + length < size) {
+            res[res_length++] = '\n';
+        }
+        i += length;
+    }
+
+    int start = 0;
+    while (start < res_length && is_space(res[start])) {
+        start += 1;
+    }
+    while (res_length > start && is_space(res[res_length - 1])) {
+        res_length -= 1;
+    }
+    memmove(res, res + start, res_length - start);
+    *res_size = res_length - start;
+    return res;
+}
+
+int match_include(const char * text, int size, const char ** name, int * name_size) {
+    if (size < 8 || memcmp(text, "#include", 8)) {
+        return 0;
+    }
+    int i = 8;
+    while (i < size && is_space(text[i])) {
+        i += 1;
+    }
+    if (i == 8 || i == size || text[i] != '"') {
+        return 0;
+    }
+    const char * end = (const char *)memchr(text + i + 1, '"', size - i - 1);
+    if (!end || end == text + i + 1) {
+        return 0;
+    }
+    *name = text + i + 1;
+    *name_size = (int)(end - *name);
+    return (int)(end - text) + 1;
+}
+
+bool expand_includes(Context * self, ShaderSource * res, const char * text, int size, PyObject * deps, PyObject ** stack, int depth) {
+    int start = 0;
+    for (int i = 0; i < size; ++i) {
+        const char * name_str = NULL;
+        int name_size = 0;
+        const int length = text[i] == '#' ? match_include(text + i, size - i, &name_str, &name_size) : 0;
+        if (!length) {
+            continue;
+        }
+
+        append_source(res, text + start, i - start);
+        i += length - 1;
+        start = i + 1;
+
+        PyObject * name = PyUnicode_FromStringAndSize(name_str, name_size);
+        if (!name) {
+            return false;
+        }
+
+        PyObject * content = PyDict_GetItemWithError(self->includes, name);
+        Py_ssize_t content_size = 0;
+        const char * content_str = content ? PyUnicode_AsUTF8AndSize(content, &content_size) : NULL;
+
+        bool recursive = false;
+        for (int j = 0; j < depth; ++j) {
+            if (PyUnicode_Compare(stack[j], name) == 0) {
+                recursive = true;
+            }
+        }
+
+        if (PyErr_Occurred()) {
+            Py_DECREF(name);
+            return false;
+        } else if (!content) {
+            PyErr_Format(PyExc_KeyError, "cannot include \"%U\"", name);
+            Py_DECREF(name);
+            return false;
+        } else if (recursive) {
+            PyErr_Format(PyExc_ValueError, "recursive include \"%U\"", name);
+            Py_DECREF(name);
+            return false;
+        } else if (depth == MAX_INCLUDE_DEPTH) {
+            PyErr_Format(PyExc_ValueError, "too many nested includes at \"%U\"", name);
+            Py_DECREF(name);
+            return false;
+        }
+
+        PyDict_SetItem(deps, name, content);
+        stack[depth] = name;
+        const bool valid = expand_includes(self, res, content_str, (int)content_size, deps, stack, depth + 1);
+        Py_DECREF(name);
+        if (!valid) {
+            return false;
+        }
+    }
+    append_source(res, text + start, size - start);
+    return true;
+}
+
+bool check_source_deps(Context * self, PyObject * deps) {
+    PyObject * name = NULL;
+    PyObject * content = NULL;
+    Py_ssize_t pos = 0;
+    while (PyDict_Next(deps, &pos, &name, &content)) {
+        PyObject * current = PyDict_GetItem(self->includes, name);
+        if (current == content) {
+            continue;
+        }
+        if (!current || !PyUnicode_Check(current) || PyUnicode_Compare(current, content)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+PyObject * preprocess_shader(Context * self, PyObject * source) {
+    if (!PyUnicode_Check(source)) {
+        PyErr_Format(PyExc_TypeError, "the shader source must be a string, got %s", Py_TYPE(source)->tp_name);
+        return NULL;
+    }
+
+    if (PyObject * cache = PyDict_GetItem(self->source_cache, source)) {
+        if (check_source_deps(self, PyTuple_GetItem(cache, 1))) {
+            self->stats.source_cache.hits += 1;
+            PyObject * res = PyTuple_GetItem(cache, 0);
+            Py_INCREF(res);
+            return res;
+        }
+    }
+    self->stats.source_cache.misses += 1;
+
+    Py_ssize_t size = 0;
+    const char * text = PyUnicode_AsUTF8AndSize(source, &size);
+    if (!text) {
+        return NULL;
+    }
+
+    int dedented_size = 0;
+    char * dedented = dedent_source(text, (int)size, &dedented_size);
+
+    ShaderSource res = {};
+    PyObject * stack[MAX_INCLUDE_DEPTH];
+    PyObject * deps = PyDict_New();
+    const bool valid = expand_includes(self, &res, dedented, dedented_size, deps, stack, 0);
+    free(dedented);
+
+    if (!valid) {
+        Py_DECREF(deps);
+        free(res.data);
+        return NULL;
+    }
+
+    PyObject * code = PyBytes_FromStringAndSize(res.data, res.size);
+    free(res.data);
+
+    PyObject * cache = Py_BuildValue("(ON)", code, deps);
+    PyDict_SetItem(self->source_cache, source, cache);
+    Py_DECREF(cache);
+    return code;
+}
+
+PyObject * get_item(PyObject * obj, const char * key) {
+    if (!PyDict_Check(obj)) {
+        PyErr_Format(PyExc_TypeError, "expected a dict, got %s", Py_TYPE(obj)->tp_name);
+        return NULL;
+    }
+    PyObject * res = PyDict_GetItemString(obj, key);
+    if (!res) {
+        PyErr_Format(PyExc_KeyError, "%s", key);
+    }
+    return res;
+}
+
+PyObject * layout_key(PyObject * layout) {
+    PyObject * seq = PySequence_Fast(layout, "the layout must be a list of dicts");
+    if (!seq) {
+        return NULL;
+    }
+
+    const int count = (int)PySequence_Fast_GET_SIZE(seq);
+    PyObject ** items = PySequence_Fast_ITEMS(seq);
+
+    PyObject * pairs = PyList_New(count);
+    for (int i = 0; i < count; ++i) {
+        PyObject * name = get_item(items[i], "name");
+        PyObject * binding = name ? get_item(items[i], "binding") : NULL;
+        if (!binding) {
+            Py_DECREF(pairs);
+            Py_DECREF(seq);
+            return NULL;
+        }
+        PyList_SET_ITEM(pairs, i, PyTuple_Pack(2, name, binding));
+    }
+
+    Py_DECREF(seq);
+    if (PyList_Sort(pairs)) {
+        Py_DECREF(pairs);
+        return NULL;
+    }
+
+    PyObject * res = PyTuple_New(count * 2);
+    for (int i = 0; i < count; ++i) {
+        PyObject * pair = PyList_GET_ITEM(pairs, i);
+        PyObject * name = PyTuple_GET_ITEM(pair, 0);
+        PyObject * binding = PyTuple_GET_ITEM(pair, 1);
+        Py_INCREF(name);
+        Py_INCREF(binding);
+        PyTuple_SET_ITEM(res, i * 2 + 0, name);
+        PyTuple_SET_ITEM(res, i * 2 + 1, binding);
+    }
+    Py_DECREF(pairs);
+    return res;
+}
+
+PyObject * preprocess_program(Context * self, PyObject * vert, PyObject * frag, PyObject * layout) {
+    PyObject * vertex_code = preprocess_shader(self, vert);
+    PyObject * fragment_code = vertex_code ? preprocess_shader(self, frag) : NULL;
+    PyObject * bindings = fragment_code ? layout_key(layout) : NULL;
+    if (!bindings) {
+        Py_XDECREF(vertex_code);
+        Py_XDECREF(fragment_code);
+        return NULL;
+    }
+    return Py_BuildValue("(NNN)", vertex_code, fragment_code, bindings);
+}
+
+void begin_program(Context * self, PyObject * key, ProgramBuild * build) {
+    const GLMethods & gl = self->gl;
+
+    *build = {key, NULL, NULL, NULL, NULL, {}};
+    build->program = PyObject_New(GLObject, self->module_state->GLObject_type);
+    build->program->key = NULL;
+    build->program->uses = 1;
+
+    build->binary_path = self->program_binary_path ? program_binary_path(self, key, &build->binary_key) : NULL;
+    if (build->binary_path) {
+        if (int program = load_program_binary(self, build->binary_path, build->binary_key)) {
+            self->stats.program_binary_cache.hits += 1;
+            free(build->binary_path);
+            build->binary_path = NULL;
+            build->program->obj = program;
+            return;
+        }
+        self->stats.program_binary_cache.misses += 1;
+    }
+
+    build->vertex_shader = issue_shader(self, PyTuple_GetItem(key, 0), GL_VERTEX_SHADER);
+    build->fragment_shader = issue_shader(self, PyTuple_GetItem(key, 1), GL_FRAGMENT_SHADER);
+
+    int program = gl.CreateProgram();
+    gl.AttachShader(program, build->vertex_shader->obj);
+    gl.AttachShader(program, build->fragment_shader->obj);
+    if (build->binary_path) {
+        gl.ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, true);
+    }
+    gl.LinkProgram(program);
+    build->program->obj = program;
+}
+
+bool check_program(Context * self, ProgramBuild * build) {
+    const GLMethods & gl = self->gl;
+
+    if (!build->vertex_shader) {
+        return true;
+    }
+
+    if (!check_shader(self, build->vertex_shader, "Vertex Shader")) {
+        return false;
+    }
+
+    if (!check_shader(self, build->fragment_shader, "Fragment Shader")) {
+        return false;
+    }
+
+    int linked = false;
+    gl.GetProgramiv(build->program->obj, GL_LINK_STATUS, &linked);
+
+    if (!linked) {
+        int log_size = 0;
+        gl.GetProgramiv(build->program->obj, GL_INFO_LOG_LENGTH, &log_size);
+        char * log_text = (char *)malloc(log_size + 1);
+        gl.GetProgramInfoLog(build->program->obj, log_size, &log_size, log_text);
+        log_text[log_size] = 0;
+        PyErr_Format(PyExc_ValueError, "Linker Error\n\n%s", log_text);
+        free(log_text);
+        return false;
+    }
+
+    if (build->binary_path) {
+        save_program_binary(self, build->binary_path, build->binary_key, build->program->obj);
+    }
+    return true;
+}
+
+bool finish_program(Context * self, ProgramBuild * build, bool check) {
+    const bool valid = check && check_program(self, build);
+    if (valid) {
+        build->program->key = (PyObject *)new_ref(build->key);
+        PyDict_SetItem(self->program_cache, build->key, (PyObject *)build->program);
+    } else {
+        self->gl.DeleteProgram(build->program->obj);
+        Py_DECREF(build->program);
+        build->program = NULL;
+    }
+    Py_XDECREF(build->vertex_shader);
+    Py_XDECREF(build->fragment_shader);
+    Py_DECREF(build->key);
+    free(build->binary_path);
+    return valid;
+}
+
+GLObject * compile_program(Context * self, PyObject * vert, PyObject * frag, PyObject * layout) {
+    PyObject * key = preprocess_program(self, vert, frag, layout);
+    if (!key) {
+        return NULL;
+    }
+
+    if (GLObject * cache = (GLObject *)PyDict_GetItem(self->program_cache, key)) {
+        self->stats.program_cache.hits += 1;
+        cache->uses += 1;
+        Py_INCREF(cache);
+        Py_DECREF(key);
+        return cache;
+    }
+    self->stats.program_cache.misses += 1;
+
+    ProgramBuild build;
+    begin_program(self, key, &build);
+    if (!finish_program(self, &build, true)) {
+        return NULL;
+    }
+    return build.program;
+}
+
+void reset_context_state(Context * self) {
+    const GLMethods & gl = self->gl;
     gl.PrimitiveRestartIndex(-1);
     gl.Enable(GL_PROGRAM_POINT_SIZE);
     gl.Enable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
     gl.Enable(GL_FRAMEBUFFER_SRGB);
+    gl.PixelStorei(GL_PACK_ALIGNMENT, 1);
+    gl.PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    self->current_buffers = NULL;
+    self->current_images = NULL;
+    self->current_global_settings = NULL;
+    memset(self->bound_buffers, -1, sizeof(self->bound_buffers));
+    memset(self->bound_images, -1, sizeof(self->bound_images));
+    self->active_texture_unit = -1;
+    self->state_valid = false;
+    self->state = {};
+    self->viewport.viewport = 0xffffffffffffffffull;
+    self->current_framebuffer = -1;
+    self->current_program = -1;
+    self->current_vertex_array = -1;
+}
+
+int has_feature(const GLMethods & gl, int version, const char * extension) {
+    int major = 0;
+    int minor = 0;
+    gl.GetIntegerv(GL_MAJOR_VERSION, &major);
+    gl.GetIntegerv(GL_MINOR_VERSION, &minor);
+    if (version && major * 10 + minor >= version) {
+        return true;
+    }
+    int extensions = 0;
+    gl.GetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (int i = 0; i < extensions; ++i) {
+        const char * name = (const char *)gl.GetStringi(GL_EXTENSIONS, i);
+        if (name && !strcmp(name, extension)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int has_buffer_storage(const GLMethods & gl) {
+    return gl.BufferStorage && has_feature(gl, 44, "GL_ARB_buffer_storage");
+}
+
+int has_parallel_shader_compile(const GLMethods & gl) {
+    if (!gl.MaxShaderCompilerThreads) {
+        return false;
+    }
+    return has_feature(gl, 0, "GL_KHR_parallel_shader_compile") || has_feature(gl, 0, "GL_ARB_parallel_shader_compile");
+}
+
+int has_program_binary(const GLMethods & gl) {
+    if (!gl.GetProgramBinary || !gl.ProgramBinary || !gl.ProgramParameteri || !has_feature(gl, 41, "GL_ARB_get_program_binary")) {
+        return false;
+    }
+    int formats = 0;
+    gl.GetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+PyObject * create_program_cache(PyObject * path) {
+    PyObject * os = PyImport_ImportModule("os");
+    if (!os) {
+        return NULL;
+    }
+    PyObject * makedirs = PyObject_GetAttrString(os, "makedirs");
+    PyObject * args = Py_BuildValue("(O)", path);
+    PyObject * kwargs = Py_BuildValue("{sO}", "exist_ok", Py_True);
+    PyObject * created = makedirs ? PyObject_Call(makedirs, args, kwargs) : NULL;
+    Py_XDECREF(makedirs);
+    Py_DECREF(args);
+    Py_DECREF(kwargs);
+    Py_DECREF(os);
+    if (!created) {
+        return NULL;
+    }
+    Py_DECREF(created);
+    PyObject * res = NULL;
+    if (!PyUnicode_FSConverter(path, &res)) {
+        return NULL;
+    }
+    return res;
+}
+
+Context * meth_context(PyObject * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"loader", "program_cache", NULL};
+
+    PyObject * loader = Py_None;
+    PyObject * program_cache = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "|O$O", keywords, &loader, &program_cache)) {
+        return NULL;
+    }
+
+    ModuleState * module_state = (ModuleState *)PyModule_GetState(self);
+
+    if (loader == Py_None) {
+        loader = PyObject_CallMethod(module_state->helper, "loader", NULL);
+        if (!loader) {
+            return NULL;
+        }
+    } else {
+        Py_INCREF(loader);
+    }
+
+    GLMethods gl = load_gl(loader);
+    Py_DECREF(loader);
+
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+
+    PyObject * program_binary_path = NULL;
+    if (program_cache != Py_None && has_program_binary(gl)) {
+        program_binary_path = create_program_cache(program_cache);
+        if (!program_binary_path) {
+            return NULL;
+        }
+    }
+
+    const int parallel_shader_compile = has_parallel_shader_compile(gl);
+    if (parallel_shader_compile) {
+        gl.MaxShaderCompilerThreads(0xffffffff);
+    }
+
+    int uniform_buffer_alignment = 0;
+    gl.GetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_buffer_alignment);
+
+    int max_texture_image_units = 0;
+    gl.GetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_texture_image_units);
+    int default_texture_unit = GL_TEXTURE0 + max_texture_image_units - 1;
 
     PyObject * info = PyTuple_New(3);
     PyTuple_SetItem(info, 0, to_str(gl.GetString(GL_VENDOR)));
@@ -634,24 +1764,103 @@ Context * meth_context(PyObject * self, PyObject * vargs, PyObject * kwargs) {
     res->framebuffer_cache = PyDict_New();
     res->program_cache = PyDict_New();
     res->shader_cache = PyDict_New();
+    res->source_cache = PyDict_New();
     res->includes = PyDict_New();
     res->info = info;
-    res->current_buffers = NULL;
-    res->current_images = NULL;
-    res->current_global_settings = NULL;
-    res->current_framebuffer = 0;
-    res->current_program = 0;
-    res->current_vertex_array = 0;
-    res->viewport = {};
     res->default_texture_unit = default_texture_unit;
     res->mapped_buffers = 0;
+    res->busy = false;
+    res->lock = PyThread_allocate_lock();
+    res->scratch = NULL;
+    res->scratch_size = 0;
+    res->pixel_buffers = NULL;
+    res->pixel_buffer_count = 0;
+    res->pixel_buffer_capacity = 0;
+    memset(res->unpack_buffers, 0, sizeof(res->unpack_buffers));
+    res->unpack_index = 0;
+    res->read_framebuffer = 0;
+    res->ring_buffers = PyList_New(0);
+    res->transient_images = PyDict_New();
+    res->transient_frame = PyList_New(0);
+    res->transient_framebuffers = PyDict_New();
+    res->buffer_storage = has_buffer_storage(gl);
+    res->uniform_buffer_alignment = uniform_buffer_alignment > 0 ? uniform_buffer_alignment : 256;
+    res->query_pool = NULL;
+    res->query_pool_count = 0;
+    res->query_pool_capacity = 0;
+    res->active_queries = 0;
+    memset(res->dropped_queries, 0, sizeof(res->dropped_queries));
+    res->program_binary_path = program_binary_path;
+    res->parallel_shader_compile = parallel_shader_compile;
+    memset(&res->memory, 0, sizeof(res->memory));
+    res->memory_budget = -1;
+    res->memory_hook = NULL;
+    memset(&res->stats, 0, sizeof(res->stats));
     res->gl = gl;
+    reset_context_state(res);
+    return res;
+}
+
+long long total_memory(Context * self) {
+    const ContextMemory & memory = self->memory;
+    return memory.buffers + memory.images + memory.renderbuffers + memory.staging;
+}
+
+bool reserve_memory(Context * self, const char * kind, long long size) {
+    if (self->memory_budget < 0 || total_memory(self) + size <= self->memory_budget) {
+        return true;
+    }
+    if (self->memory_hook && self->memory_hook != Py_None) {
+        PyObject * res = PyObject_CallFunction(self->memory_hook, "sL", kind, size);
+        if (!res) {
+            return false;
+        }
+        Py_DECREF(res);
+        if (self->memory_budget < 0 || total_memory(self) + size <= self->memory_budget) {
+            return true;
+        }
+    }
+    PyErr_Format(
+        PyExc_MemoryError, "the %s of %lld bytes exceeds the memory budget (%lld of %lld bytes in use)",
+        kind, size, total_memory(self), self->memory_budget
+    );
+    return false;
+}
+
+Buffer * create_buffer(Context * self, int size, const void * data, int dynamic) {
+    const GLMethods & gl = self->gl;
+
+    if (!reserve_memory(self, "buffer", size)) {
+        return NULL;
+    }
+
+    int buffer = 0;
+    gl.GenBuffers(1, (unsigned *)&buffer);
+    gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
+    PyThreadState * state = begin_allow_threads(self, data ? size : 0);
+    gl.BufferData(GL_ARRAY_BUFFER, size, data, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+    end_allow_threads(self, state);
+    self->stats.bytes_uploaded += data ? size : 0;
+
+    Buffer * res = PyObject_New(Buffer, self->module_state->Buffer_type);
+    res->ctx = (Context *)new_ref(self);
+    res->buffer = buffer;
+    res->size = size;
+    res->mapped = false;
+    res->ring = false;
+    res->frame_offset = 0;
+    res->memory = size;
+    self->memory.buffers += size;
+
+    Py_INCREF(res);
     return res;
 }
 
 Buffer * Context_meth_buffer(Context * self, PyObject * vargs, PyObject * kwargs) {
     static char * keywords[] = {"data", "size", "dynamic", NULL};
 
+    wait_context(self);
+
     PyObject * data = Py_None;
     PyObject * size_arg = Py_None;
     int dynamic = true;
@@ -660,8 +1869,6 @@ Buffer * Context_meth_buffer(Context * self, PyObject * vargs, PyObject * kwargs
         return NULL;
     }
 
-    const GLMethods & gl = self->gl;
-
     Py_buffer view = {};
 
     if (data != Py_None) {
@@ -694,31 +1901,23 @@ Buffer * Context_meth_buffer(Context * self, PyObject * vargs, PyObject * kwargs
         return NULL;
     }
 
-    int buffer = 0;
-    gl.GenBuffers(1, (unsigned *)&buffer);
-    gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
-    gl.BufferData(GL_ARRAY_BUFFER, size, view.buf, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
-
-    Buffer * res = PyObject_New(Buffer, self->module_state->Buffer_type);
-    res->ctx = (Context *)new_ref(self);
-    res->buffer = buffer;
-    res->size = size;
-    res->mapped = false;
+    Buffer * res = create_buffer(self, size, view.buf, dynamic);
 
     if (data != Py_None) {
         PyBuffer_Release(&view);
     }
 
-    Py_INCREF(res);
     return res;
 }
 
 Image * Context_meth_image(Context * self, PyObject * vargs, PyObject * kwargs) {
     static char * keywords[] = {"size", "format", "data", "samples", "array", "texture", "cubemap", NULL};
 
+    wait_context(self);
+
     int width;
     int height;
-    const char * format_str;
+    PyObject * format_name;
     PyObject * data = Py_None;
     int samples = 1;
     int array = 0;
@@ -728,11 +1927,11 @@ Image * Context_meth_image(Context * self, PyObject * vargs, PyObject * kwargs)
     int args_ok = PyArg_ParseTupleAndKeywords(
         vargs,
         kwargs,
-        "(ii)s|O$iiOp",
+        "(ii)O|O$iiOp",
         keywords,
         &width,
         &height,
-        &format_str,
+        &format_name,
         &data,
         &samples,
         &array,
@@ -746,13 +1945,18 @@ Image * Context_meth_image(Context * self, PyObject * vargs, PyObject * kwargs)
 
     const GLMethods & gl = self->gl;
 
+    PyObject * format_index = PyDict_GetItem(self->module_state->image_format_table, format_name);
+
+    const bool invalid_format = !format_index;
     const bool invalid_texture_parameter = texture != Py_True && texture != Py_False && texture != Py_None;
     const bool samples_but_texture = samples > 1 && texture == Py_True;
     const bool cubemap_array = cubemap && array;
     const bool cubemap_or_array_renderbuffer = (array || cubemap) && (samples > 1 || texture == Py_False);
 
-    if (invalid_texture_parameter || samples_but_texture || cubemap_array || cubemap_or_array_renderbuffer) {
-        if (invalid_texture_parameter) {
+    if (invalid_format || invalid_texture_parameter || samples_but_texture || cubemap_array || cubemap_or_array_renderbuffer) {
+        if (invalid_format) {
+            PyErr_Format(PyExc_ValueError, "invalid image format %R", format_name);
+        } else if (invalid_texture_parameter) {
             PyErr_Format(PyExc_TypeError, "invalid texture parameter");
         } else if (samples_but_texture) {
             PyErr_Format(PyExc_TypeError, "for multisampled images texture must be False");
@@ -781,28 +1985,42 @@ Image * Context_meth_image(Context * self, PyObject * vargs, PyObject * kwargs)
         }
     }
 
-    ImageFormat format = get_image_format(format_str);
+    ImageFormat format = image_formats[PyLong_AsLong(format_index)].format;
+
+    const int layers = (array ? array : 1) * (cubemap ? 6 : 1) * samples;
+    const long long memory = image_memory(width, height, layers, format.pixel_size, 1);
+    if (!reserve_memory(self, renderbuffer ? "renderbuffer" : "image", memory)) {
+        if (data != Py_None) {
+            PyBuffer_Release(&view);
+        }
+        return NULL;
+    }
 
     int image = 0;
     if (renderbuffer) {
         gl.GenRenderbuffers(1, (unsigned *)&image);
         gl.BindRenderbuffer(GL_RENDERBUFFER, image);
         gl.RenderbufferStorageMultisample(GL_RENDERBUFFER, samples, format.internal_format, width, height);
+        self->memory.renderbuffers += memory;
     } else {
         gl.GenTextures(1, (unsigned *)&image);
-        gl.ActiveTexture(self->default_texture_unit);
-        gl.BindTexture(target, image);
+        bind_default_texture(self, target, image);
+        self->stats.bytes_uploaded += view.len;
+        PyThreadState * state = begin_allow_threads(self, view.len);
         if (cubemap) {
-            int stride = width * height * format.pixel_size / 6;
+            int stride = width * height * format.pixel_size;
             for (int i = 0; i < 6; ++i) {
                 int face = GL_TEXTURE_CUBE_MAP_POSITIVE_X + i;
-                gl.TexImage2D(face, 0, format.internal_format, width, height, 0, format.format, format.type, (char *)view.buf + stride * i);
+                char * face_data = view.buf ? (char *)view.buf + stride * i : NULL;
+                gl.TexImage2D(face, 0, format.internal_format, width, height, 0, format.format, format.type, face_data);
             }
         } else if (array) {
             gl.TexImage3D(target, 0, format.internal_format, width, height, array, 0, format.format, format.type, view.buf);
         } else {
             gl.TexImage2D(target, 0, format.internal_format, width, height, 0, format.format, format.type, view.buf);
         }
+        end_allow_threads(self, state);
+        self->memory.images += memory;
     }
 
     ClearValue clear_value = {};
@@ -823,6 +2041,9 @@ Image * Context_meth_image(Context * self, PyObject * vargs, PyObject * kwargs)
     res->cubemap = cubemap;
     res->target = target;
     res->renderbuffer = renderbuffer;
+    res->mapped_buffer = NULL;
+    res->memory = memory;
+    res->transient = false;
 
     res->framebuffer = 0;
     if (!cubemap && !array) {
@@ -845,6 +2066,688 @@ Image * Context_meth_image(Context * self, PyObject * vargs, PyObject * kwargs)
     return res;
 }
 
+const int UNIFORM_BUFFER_RESOURCE = 1;
+const int SAMPLER_RESOURCE = 2;
+const int MAX_RESOURCES = MAX_UNIFORM_BUFFER_BINDINGS + MAX_SAMPLER_BINDINGS;
+
+struct ResourceBinding {
+    PyObject * obj;
+    int type;
+    int binding;
+};
+
+struct LayoutBinding {
+    PyObject * name;
+    const char * name_str;
+    int binding;
+    int type;
+    int bound;
+};
+
+struct ProgramInput {
+    char name[256];
+    int location;
+    int bound;
+};
+
+int lookup_enum(PyObject * table, PyObject * name) {
+    PyObject * value = PyDict_GetItemWithError(table, name);
+    if (!value) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetObject(PyExc_KeyError, name);
+        }
+        return -1;
+    }
+    return PyLong_AsLong(value);
+}
+
+int get_enum(PyObject * table, PyObject * obj, const char * key, int default_value) {
+    PyObject * name = PyDict_GetItemString(obj, key);
+    return name ? lookup_enum(table, name) : default_value;
+}
+
+int get_int(PyObject * obj, const char * key, int default_value) {
+    PyObject * value = PyDict_GetItemString(obj, key);
+    return value ? PyLong_AsLong(value) : default_value;
+}
+
+double get_float(PyObject * obj, const char * key, double default_value) {
+    PyObject * value = PyDict_GetItemString(obj, key);
+    return value ? PyFloat_AsDouble(value) : default_value;
+}
+
+PyObject * framebuffer_attachments(Context * self, PyObject * framebuffer) {
+    if (!framebuffer) {
+        PyErr_Format(PyExc_TypeError, "missing framebuffer");
+        return NULL;
+    }
+
+    PyObject * seq = PySequence_Fast(framebuffer, "the framebuffer must be a list of images");
+    if (!seq) {
+        return NULL;
+    }
+
+    const int count = (int)PySequence_Fast_GET_SIZE(seq);
+    PyObject ** items = PySequence_Fast_ITEMS(seq);
+
+    bool invalid_type = !count;
+    for (int i = 0; i < count; ++i) {
+        invalid_type = invalid_type || Py_TYPE(items[i]) != self->module_state->Image_type;
+    }
+
+    bool invalid_size = false;
+    bool invalid_samples = false;
+    bool misplaced_depth = false;
+    int color_count = count;
+    PyObject * depth_stencil_attachment = Py_None;
+
+    if (!invalid_type) {
+        Image * first = (Image *)items[0];
+        for (int i = 0; i < count; ++i) {
+            Image * image = (Image *)items[i];
+            invalid_size = invalid_size || image->width != first->width || image->height != first->height;
+            invalid_samples = invalid_samples || image->samples != first->samples;
+        }
+        if (!((Image *)items[count - 1])->format.color) {
+            depth_stencil_attachment = items[count - 1];
+            color_count -= 1;
+        }
+        for (int i = 0; i < color_count; ++i) {
+            misplaced_depth = misplaced_depth || !((Image *)items[i])->format.color;
+        }
+    }
+
+    const bool too_many_attachments = color_count > MAX_ATTACHMENTS;
+
+    if (invalid_type || invalid_size || invalid_samples || misplaced_depth || too_many_attachments) {
+        if (invalid_type) {
+            PyErr_Format(PyExc_TypeError, "the framebuffer must be a non-empty list of images");
+        } else if (invalid_size) {
+            PyErr_Format(PyExc_ValueError, "Attachments must be images with the same size");
+        } else if (invalid_samples) {
+            PyErr_Format(PyExc_ValueError, "Attachments must be images with the same number of samples");
+        } else if (misplaced_depth) {
+            PyErr_Format(PyExc_ValueError, "The depth stencil attachments must be the last item in the framebuffer");
+        } else if (too_many_attachments) {
+            PyErr_Format(PyExc_ValueError, "too many color attachments");
+        }
+        Py_DECREF(seq);
+        return NULL;
+    }
+
+    PyObject * color_attachments = PyTuple_New(color_count);
+    for (int i = 0; i < color_count; ++i) {
+        PyTuple_SET_ITEM(color_attachments, i, (PyObject *)new_ref(items[i]));
+    }
+
+    Py_DECREF(seq);
+    return Py_BuildValue("(NO)", color_attachments, depth_stencil_attachment);
+}
+
+PyObject * vertex_array_bindings(Context * self, PyObject * vertex_buffers, PyObject * index_buffer) {
+    ModuleState * module_state = self->module_state;
+
+    if (index_buffer != Py_None && Py_TYPE(index_buffer) != module_state->Buffer_type) {
+        PyErr_Format(PyExc_TypeError, "the index_buffer must be a Buffer or None");
+        return NULL;
+    }
+
+    if (index_buffer != Py_None && ((Buffer *)index_buffer)->ring) {
+        PyErr_Format(PyExc_ValueError, "ring buffers cannot be used as index buffers");
+        return NULL;
+    }
+
+    PyObject * seq = PySequence_Fast(vertex_buffers, "vertex_buffers must be a list of dicts");
+    if (!seq) {
+        return NULL;
+    }
+
+    const int count = (int)PySequence_Fast_GET_SIZE(seq);
+    PyObject ** items = PySequence_Fast_ITEMS(seq);
+
+    PyObject * res = PyTuple_New(count * 6 + 1);
+    PyTuple_SET_ITEM(res, 0, (PyObject *)new_ref(index_buffer));
+
+    for (int i = 0; i < count; ++i) {
+        PyObject * buffer = get_item(items[i], "buffer");
+        PyObject * location = buffer ? get_item(items[i], "location") : NULL;
+        PyObject * offset = location ? get_item(items[i], "offset") : NULL;
+        PyObject * stride = offset ? get_item(items[i], "stride") : NULL;
+        PyObject * step = stride ? get_item(items[i], "step") : NULL;
+        PyObject * format = step ? get_item(items[i], "format") : NULL;
+        const int divisor = format ? lookup_enum(module_state->vertex_step_table, step) : -1;
+        const int format_index = divisor >= 0 ? lookup_enum(module_state->vertex_format_table, format) : -1;
+
+        if (format_index >= 0 && Py_TYPE(buffer) != module_state->Buffer_type) {
+            PyErr_Format(PyExc_TypeError, "the vertex buffers must be Buffer objects");
+        } else if (format_index >= 0 && ((Buffer *)buffer)->ring) {
+            PyErr_Format(PyExc_ValueError, "ring buffers cannot be used as vertex buffers");
+        }
+
+        if (PyErr_Occurred()) {
+            Py_DECREF(res);
+            Py_DECREF(seq);
+            return NULL;
+        }
+
+        PyTuple_SET_ITEM(res, i * 6 + 1, (PyObject *)new_ref(buffer));
+        PyTuple_SET_ITEM(res, i * 6 + 2, (PyObject *)new_ref(location));
+        PyTuple_SET_ITEM(res, i * 6 + 3, (PyObject *)new_ref(offset));
+        PyTuple_SET_ITEM(res, i * 6 + 4, (PyObject *)new_ref(stride));
+        PyTuple_SET_ITEM(res, i * 6 + 5, PyLong_FromLong(divisor));
+        PyTuple_SET_ITEM(res, i * 6 + 6, (PyObject *)new_ref(format));
+    }
+
+    Py_DECREF(seq);
+    return res;
+}
+
+int parse_layout(PyObject * layout, LayoutBinding ** res) {
+    PyObject * seq = PySequence_Fast(layout, "the layout must be a list of dicts");
+    if (!seq) {
+        return -1;
+    }
+
+    const int count = (int)PySequence_Fast_GET_SIZE(seq);
+    PyObject ** items = PySequence_Fast_ITEMS(seq);
+
+    *res = (LayoutBinding *)malloc(count * sizeof(LayoutBinding) + 1);
+    for (int i = 0; i < count; ++i) {
+        PyObject * name = get_item(items[i], "name");
+        PyObject * binding = name ? get_item(items[i], "binding") : NULL;
+        const char * name_str = binding ? PyUnicode_AsUTF8(name) : NULL;
+        if (!name_str) {
+            break;
+        }
+        (*res)[i] = {name, name_str, PyLong_AsLong(binding), 0, false};
+    }
+
+    Py_DECREF(seq);
+    if (PyErr_Occurred()) {
+        free(*res);
+        return -1;
+    }
+    return count;
+}
+
+int parse_resources(PyObject * resources, ResourceBinding * res) {
+    PyObject * seq = PySequence_Fast(resources, "the resources must be a list of dicts");
+    if (!seq) {
+        return -1;
+    }
+
+    const int count = (int)PySequence_Fast_GET_SIZE(seq);
+    PyObject ** items = PySequence_Fast_ITEMS(seq);
+
+    if (count > MAX_RESOURCES) {
+        PyErr_Format(PyExc_ValueError, "too many resources");
+        Py_DECREF(seq);
+        return -1;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        PyObject * type = get_item(items[i], "type");
+        PyObject * binding = type ? get_item(items[i], "binding") : NULL;
+        if (!binding) {
+            break;
+        }
+        res[i].obj = items[i];
+        res[i].binding = PyLong_AsLong(binding);
+        res[i].type = 0;
+        if (PyUnicode_Check(type) && !PyUnicode_CompareWithASCIIString(type, "uniform_buffer")) {
+            res[i].type = UNIFORM_BUFFER_RESOURCE;
+        } else if (PyUnicode_Check(type) && !PyUnicode_CompareWithASCIIString(type, "sampler")) {
+            res[i].type = SAMPLER_RESOURCE;
+        }
+    }
+
+    Py_DECREF(seq);
+    return PyErr_Occurred() ? -1 : count;
+}
+
+int find_program_input(ProgramInput * inputs, int count, const char * name) {
+    for (int i = count - 1; i >= 0; --i) {
+        if (!strcmp(inputs[i].name, name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int find_layout_binding(LayoutBinding * layout, int count, const char * name, int type, int binding) {
+    for (int i = count - 1; i >= 0; --i) {
+        if (name ? !strcmp(layout[i].name_str, name) : layout[i].type == type && layout[i].binding == binding) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool has_resource(ResourceBinding * resources, int count, int type, int binding) {
+    for (int i = 0; i < count; ++i) {
+        if (resources[i].type == type && resources[i].binding == binding) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool validate_pipeline(
+    Context * self, int program, PyObject * vertex_buffers,
+    LayoutBinding * layout, int layout_count, ResourceBinding * resources, int resource_count
+) {
+    const GLMethods & gl = self->gl;
+
+    int attribute_count = 0;
+    int uniform_count = 0;
+    int uniform_buffer_count = 0;
+    gl.GetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &attribute_count);
+    gl.GetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniform_count);
+    gl.GetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &uniform_buffer_count);
+
+    ProgramInput * attributes = (ProgramInput *)malloc((attribute_count + uniform_count + uniform_buffer_count + 1) * sizeof(ProgramInput));
+    ProgramInput * uniforms = attributes + attribute_count;
+    ProgramInput * uniform_buffers = uniforms + uniform_count;
+
+    for (int i = 0; i < attribute_count; ++i) {
+        int size = 0;
+        int type = 0;
+        int length = 0;
+        gl.GetActiveAttrib(program, i, 256, &length, &size, (unsigned *)&type, attributes[i].name);
+        attributes[i].location = gl.GetAttribLocation(program, attributes[i].name);
+        attributes[i].bound = false;
+    }
+
+    for (int i = 0; i < uniform_count; ++i) {
+        int size = 0;
+        int type = 0;
+        int length = 0;
+        gl.GetActiveUniform(program, i, 256, &length, &size, (unsigned *)&type, uniforms[i].name);
+        uniforms[i].location = gl.GetUniformLocation(program, uniforms[i].name);
+    }
+
+    for (int i = 0; i < uniform_buffer_count; ++i) {
+        int length = 0;
+        gl.GetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &uniform_buffers[i].location);
+        gl.GetActiveUniformBlockName(program, i, 256, &length, uniform_buffers[i].name);
+    }
+
+    PyObject * seq = PySequence_Fast(vertex_buffers, "vertex_buffers must be a list of dicts");
+    const int vertex_buffer_count = seq ? (int)PySequence_Fast_GET_SIZE(seq) : 0;
+    PyObject ** items = seq ? PySequence_Fast_ITEMS(seq) : NULL;
+
+    for (int i = 0; i < vertex_buffer_count && !PyErr_Occurred(); ++i) {
+        PyObject * location_obj = get_item(items[i], "location");
+        const int location = location_obj ? PyLong_AsLong(location_obj) : -1;
+        if (location < 0) {
+            continue;
+        }
+        int attribute = -1;
+        for (int j = 0; j < attribute_count; ++j) {
+            if (attributes[j].location == location) {
+                attribute = j;
+            }
+        }
+        if (attribute < 0) {
+            PyErr_Format(PyExc_ValueError, "Invalid vertex attribute location %d", location);
+        } else if (attributes[attribute].bound) {
+            PyErr_Format(PyExc_ValueError, "Duplicate vertex attribute binding for \"%s\" at location %d", attributes[attribute].name, location);
+        } else {
+            attributes[attribute].bound = true;
+        }
+    }
+
+    Py_XDECREF(seq);
+
+    for (int i = 0; i < attribute_count && !PyErr_Occurred(); ++i) {
+        if (attributes[i].location >= 0 && !attributes[i].bound) {
+            PyErr_Format(PyExc_ValueError, "Unbound vertex attribute \"%s\" at location %d", attributes[i].name, attributes[i].location);
+        }
+    }
+
+    for (int i = 0; i < layout_count && !PyErr_Occurred(); ++i) {
+        if (find_program_input(uniforms, uniform_count, layout[i].name_str) >= 0) {
+            layout[i].type = SAMPLER_RESOURCE;
+        } else if (find_program_input(uniform_buffers, uniform_buffer_count, layout[i].name_str) >= 0) {
+            layout[i].type = UNIFORM_BUFFER_RESOURCE;
+        } else {
+            PyErr_Format(PyExc_ValueError, "Cannot set layout binding for \"%s\"", layout[i].name_str);
+        }
+    }
+
+    for (int i = 0; i < uniform_count && !PyErr_Occurred(); ++i) {
+        if (uniforms[i].location < 0) {
+            continue;
+        }
+        const int index = find_layout_binding(layout, layout_count, uniforms[i].name, 0, 0);
+        if (index < 0) {
+            PyErr_Format(PyExc_ValueError, "Missing layout binding for \"%s\"", uniforms[i].name);
+        } else if (!has_resource(resources, resource_count, SAMPLER_RESOURCE, layout[index].binding)) {
+            PyErr_Format(PyExc_ValueError, "Missing resource for \"%s\" with binding %d", uniforms[i].name, layout[index].binding);
+        }
+    }
+
+    for (int i = 0; i < uniform_buffer_count && !PyErr_Occurred(); ++i) {
+        const int index = find_layout_binding(layout, layout_count, uniform_buffers[i].name, 0, 0);
+        if (index < 0) {
+            PyErr_Format(PyExc_ValueError, "Missing layout binding for \"%s\"", uniform_buffers[i].name);
+        } else if (!has_resource(resources, resource_count, UNIFORM_BUFFER_RESOURCE, layout[index].binding)) {
+            PyErr_Format(PyExc_ValueError, "Missing resource for \"%s\" with binding %d", uniform_buffers[i].name, layout[index].binding);
+        }
+    }
+
+    for (int i = 0; i < resource_count && !PyErr_Occurred(); ++i) {
+        const int binding = resources[i].binding;
+        if (resources[i].type == UNIFORM_BUFFER_RESOURCE) {
+            Buffer * buffer = (Buffer *)get_item(resources[i].obj, "buffer");
+            const int index = buffer ? find_layout_binding(layout, layout_count, NULL, UNIFORM_BUFFER_RESOURCE, binding) : -1;
+            const char * name = index >= 0 ? layout[index].name_str : NULL;
+            const int size = name ? uniform_buffers[find_program_input(uniform_buffers, uniform_buffer_count, name)].location : 0;
+            if (!buffer) {
+                break;
+            } else if (Py_TYPE(buffer) != self->module_state->Buffer_type) {
+                PyErr_Format(PyExc_TypeError, "the uniform buffer with binding %d must be a Buffer", binding);
+            } else if (index < 0) {
+                PyErr_Format(PyExc_ValueError, "Uniform buffer binding %d does not exist", binding);
+            } else if (layout[index].bound) {
+                PyErr_Format(PyExc_ValueError, "Duplicate uniform buffer binding for \"%s\" with binding %d", name, binding);
+            } else if (binding < 0 || binding >= MAX_UNIFORM_BUFFER_BINDINGS) {
+                PyErr_Format(PyExc_ValueError, "Invalid uniform buffer binding %d for \"%s\"", binding, name);
+            } else if (buffer->size < size) {
+                PyErr_Format(PyExc_ValueError, "Uniform buffer is too small %d is less than %d for \"%s\" with binding %d", buffer->size, size, name, binding);
+            }
+            if (index >= 0) {
+                layout[index].bound = true;
+            }
+        } else if (resources[i].type == SAMPLER_RESOURCE) {
+            Image * image = (Image *)get_item(resources[i].obj, "image");
+            const int index = image ? find_layout_binding(layout, layout_count, NULL, SAMPLER_RESOURCE, binding) : -1;
+            const char * name = index >= 0 ? layout[index].name_str : NULL;
+            if (!image) {
+                break;
+            } else if (Py_TYPE(image) != self->module_state->Image_type) {
+                PyErr_Format(PyExc_TypeError, "the sampler with binding %d must have an Image", binding);
+            } else if (index < 0) {
+                PyErr_Format(PyExc_ValueError, "Sampler binding %d does not exist", binding);
+            } else if (layout[index].bound) {
+                PyErr_Format(PyExc_ValueError, "Duplicate sampler binding for \"%s\" with binding %d", name, binding);
+            } else if (binding < 0 || binding >= MAX_SAMPLER_BINDINGS) {
+                PyErr_Format(PyExc_ValueError, "Invalid sampler binding %d for \"%s\"", binding, name);
+            } else if (image->samples != 1) {
+                PyErr_Format(PyExc_ValueError, "Multisample images cannot be attached to \"%s\" with binding %d", name, binding);
+            }
+            if (index >= 0) {
+                layout[index].bound = true;
+            }
+        } else {
+            PyErr_Format(PyExc_ValueError, "Invalid resource type \"%S\"", PyDict_GetItemString(resources[i].obj, "type"));
+        }
+    }
+
+    free(attributes);
+    return !PyErr_Occurred();
+}
+
+void sort_resources(ResourceBinding * resources, int count) {
+    for (int i = 1; i < count; ++i) {
+        ResourceBinding item = resources[i];
+        int j = i;
+        while (j > 0 && resources[j - 1].binding > item.binding) {
+            resources[j] = resources[j - 1];
+            j -= 1;
+        }
+        resources[j] = item;
+    }
+}
+
+int count_resources(ResourceBinding * resources, int count, int type) {
+    int res = 0;
+    for (int i = 0; i < count; ++i) {
+        res += resources[i].type == type;
+    }
+    return res;
+}
+
+PyObject * buffer_bindings(ResourceBinding * resources, int count) {
+    PyObject * res = PyTuple_New(count_resources(resources, count, UNIFORM_BUFFER_RESOURCE) * 4);
+    int idx = 0;
+    for (int i = 0; i < count; ++i) {
+        if (resources[i].type != UNIFORM_BUFFER_RESOURCE) {
+            continue;
+        }
+        PyObject * obj = resources[i].obj;
+        Buffer * buffer = (Buffer *)PyDict_GetItemString(obj, "buffer");
+        const int offset = get_int(obj, "offset", 0);
+        const int size = get_int(obj, "size", buffer->size - offset);
+        PyTuple_SET_ITEM(res, idx++, PyLong_FromLong(resources[i].binding));
+        PyTuple_SET_ITEM(res, idx++, (PyObject *)new_ref(buffer));
+        PyTuple_SET_ITEM(res, idx++, PyLong_FromLong(offset));
+        PyTuple_SET_ITEM(res, idx++, PyLong_FromLong(size));
+    }
+    if (PyErr_Occurred()) {
+        Py_DECREF(res);
+        return NULL;
+    }
+    return res;
+}
+
+PyObject * sampler_bindings(Context * self, ResourceBinding * resources, int count) {
+    ModuleState * module_state = self->module_state;
+    PyObject * res = PyTuple_New(count_resources(resources, count, SAMPLER_RESOURCE) * 3);
+    int idx = 0;
+    for (int i = 0; i < count && !PyErr_Occurred(); ++i) {
+        if (resources[i].type != SAMPLER_RESOURCE) {
+            continue;
+        }
+        PyObject * obj = resources[i].obj;
+        double border_color[4] = {};
+        if (PyObject * color = PyDict_GetItemString(obj, "border_color")) {
+            PyObject * seq = PySequence_Fast(color, "the border_color must be a tuple of 4 floats");
+            if (!seq || PySequence_Fast_GET_SIZE(seq) != 4) {
+                if (seq) {
+                    PyErr_Format(PyExc_ValueError, "the border_color must be a tuple of 4 floats");
+                    Py_DECREF(seq);
+                }
+                break;
+            }
+            for (int j = 0; j < 4; ++j) {
+                border_color[j] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(seq, j));
+            }
+            Py_DECREF(seq);
+        }
+        const int min_filter = get_enum(module_state->min_filter_table, obj, "min_filter", GL_LINEAR);
+        const int mag_filter = get_enum(module_state->mag_filter_table, obj, "mag_filter", GL_LINEAR);
+        const double min_lod = get_float(obj, "min_lod", -1000.0);
+        const double max_lod = get_float(obj, "max_lod", 1000.0);
+        const double lod_bias = get_float(obj, "lod_bias", 0.0);
+        const int wrap_x = get_enum(module_state->texture_wrap_table, obj, "wrap_x", GL_REPEAT);
+        const int wrap_y = get_enum(module_state->texture_wrap_table, obj, "wrap_y", GL_REPEAT);
+        const int wrap_z = get_enum(module_state->texture_wrap_table, obj, "wrap_z", GL_REPEAT);
+        const int compare_mode = get_enum(module_state->compare_mode_table, obj, "compare_mode", 0);
+        const int compare_func = get_enum(module_state->compare_func_table, obj, "compare_func", GL_NEVER);
+        if (PyErr_Occurred()) {
+            break;
+        }
+        PyObject * params = Py_BuildValue(
+            "(iidddiiiiidddd)",
+            min_filter, mag_filter, min_lod, max_lod, lod_bias, wrap_x, wrap_y, wrap_z, compare_mode, compare_func,
+            border_color[0], border_color[1], border_color[2], border_color[3]
+        );
+        PyTuple_SET_ITEM(res, idx++, PyLong_FromLong(resources[i].binding));
+        PyTuple_SET_ITEM(res, idx++, (PyObject *)new_ref(PyDict_GetItemString(obj, "image")));
+        PyTuple_SET_ITEM(res, idx++, params);
+    }
+    if (PyErr_Occurred()) {
+        Py_DECREF(res);
+        return NULL;
+    }
+    return res;
+}
+
+bool parse_stencil_settings(Context * self, PyObject * face, StencilSettings * res) {
+    ModuleState * module_state = self->module_state;
+    if (!PyDict_Check(face)) {
+        PyErr_Format(PyExc_TypeError, "expected a dict, got %s", Py_TYPE(face)->tp_name);
+        return false;
+    }
+    res->fail_op = get_enum(module_state->stencil_op_table, face, "fail_op", GL_KEEP);
+    res->pass_op = get_enum(module_state->stencil_op_table, face, "pass_op", GL_KEEP);
+    res->depth_fail_op = get_enum(module_state->stencil_op_table, face, "depth_fail_op", GL_KEEP);
+    res->compare_op = get_enum(module_state->compare_func_table, face, "compare_op", GL_ALWAYS);
+    res->compare_mask = get_int(face, "compare_mask", 0xff);
+    res->write_mask = get_int(face, "write_mask", 0xff);
+    res->reference = get_int(face, "reference", 0);
+    return !PyErr_Occurred();
+}
+
+PyObject * pipeline_settings(
+    Context * self, PyObject * primitive_restart, PyObject * line_width, PyObject * front_face, PyObject * cull_face,
+    PyObject * color_mask, PyObject * depth, PyObject * stencil, PyObject * blending, PyObject * polygon_offset, int attachments
+) {
+    ModuleState * module_state = self->module_state;
+
+    const int front_face_value = lookup_enum(module_state->front_face_table, front_face);
+    const int cull_face_value = front_face_value >= 0 ? lookup_enum(module_state->cull_face_table, cull_face) : -1;
+    if (cull_face_value < 0) {
+        return NULL;
+    }
+
+    int depth_test = depth == Py_True;
+    int depth_write = depth == Py_True;
+    int depth_func = GL_LESS;
+    if (depth != Py_True && depth != Py_False) {
+        PyObject * test = get_item(depth, "test");
+        PyObject * write = test ? get_item(depth, "write") : NULL;
+        PyObject * func = write ? get_item(depth, "func") : NULL;
+        if (!func) {
+            return NULL;
+        }
+        depth_test = PyObject_IsTrue(test);
+        depth_write = PyObject_IsTrue(write);
+        depth_func = lookup_enum(module_state->compare_func_table, func);
+    }
+
+    int stencil_test = true;
+    StencilSettings stencil_front = {GL_KEEP, GL_KEEP, GL_KEEP, GL_ALWAYS, 0xff, 0xff, 0};
+    StencilSettings stencil_back = stencil_front;
+    if (stencil != Py_False) {
+        PyObject * test = get_item(stencil, "test");
+        if (!test) {
+            return NULL;
+        }
+        PyObject * both = PyDict_GetItemString(stencil, "both");
+        PyObject * front = PyDict_GetItemString(stencil, "front");
+        PyObject * back = PyDict_GetItemString(stencil, "back");
+        stencil_test = PyObject_IsTrue(test);
+        if ((front || both) && !parse_stencil_settings(self, front ? front : both, &stencil_front)) {
+            return NULL;
+        }
+        if ((back || both) && !parse_stencil_settings(self, back ? back : both, &stencil_back)) {
+            return NULL;
+        }
+    }
+
+    int blend_enable = 0;
+    int blend_src_color = GL_ONE;
+    int blend_dst_color = GL_ZERO;
+    int blend_src_alpha = GL_ONE;
+    int blend_dst_alpha = GL_ZERO;
+    if (blending != Py_False) {
+        PyObject * enable = get_item(blending, "enable");
+        if (!enable) {
+            return NULL;
+        }
+        blend_enable = PyLong_AsLong(enable);
+        blend_src_color = get_enum(module_state->blend_constant_table, blending, "src_color", GL_ONE);
+        blend_dst_color = get_enum(module_state->blend_constant_table, blending, "dst_color", GL_ZERO);
+        blend_src_alpha = get_enum(module_state->blend_constant_table, blending, "src_alpha", GL_ONE);
+        blend_dst_alpha = get_enum(module_state->blend_constant_table, blending, "dst_alpha", GL_ZERO);
+    }
+
+    int polygon_offset_enable = false;
+    double polygon_offset_factor = 0.0;
+    double polygon_offset_units = 0.0;
+    if (polygon_offset != Py_False) {
+        PyObject * factor = get_item(polygon_offset, "factor");
+        PyObject * units = factor ? get_item(polygon_offset, "units") : NULL;
+        if (!units) {
+            return NULL;
+        }
+        polygon_offset_enable = true;
+        polygon_offset_factor = PyFloat_AsDouble(factor);
+        polygon_offset_units = PyFloat_AsDouble(units);
+    }
+
+    const int primitive_restart_value = PyObject_IsTrue(primitive_restart);
+    const double line_width_value = PyFloat_AsDouble(line_width);
+
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+
+    return Py_BuildValue(
+        "(NdiiONNiNiiiiiiiiiiiiiiiiiiiNddi)",
+        PyBool_FromLong(primitive_restart_value),
+        line_width_value,
+        front_face_value,
+        cull_face_value,
+        color_mask,
+        PyBool_FromLong(depth_test),
+        PyBool_FromLong(depth_write),
+        depth_func,
+        PyBool_FromLong(stencil_test),
+        stencil_front.fail_op,
+        stencil_front.pass_op,
+        stencil_front.depth_fail_op,
+        stencil_front.compare_op,
+        stencil_front.compare_mask,
+        stencil_front.write_mask,
+        stencil_front.reference,
+        stencil_back.fail_op,
+        stencil_back.pass_op,
+        stencil_back.depth_fail_op,
+        stencil_back.compare_op,
+        stencil_back.compare_mask,
+        stencil_back.write_mask,
+        stencil_back.reference,
+        blend_enable,
+        blend_src_color,
+        blend_dst_color,
+        blend_src_alpha,
+        blend_dst_alpha,
+        PyBool_FromLong(polygon_offset_enable),
+        polygon_offset_factor,
+        polygon_offset_units,
+        attachments
+    );
+}
+
+void release_program(Context * self, GLObject * program) {
+    program->uses -= 1;
+    if (!program->uses) {
+        if (self->current_program == program->obj) {
+            self->current_program = -1;
+        }
+        self->gl.DeleteProgram(program->obj);
+        remove_dict_key(self->program_cache, &program->key);
+    }
+}
+
+void pin_transient_framebuffer(Context * self, PyObject * attachments, GLObject * framebuffer) {
+    PyObject * color_attachments = PyTuple_GET_ITEM(attachments, 0);
+    PyObject * depth_stencil_attachment = PyTuple_GET_ITEM(attachments, 1);
+
+    bool transient = depth_stencil_attachment != Py_None && ((Image *)depth_stencil_attachment)->transient;
+    for (int i = 0; i < PyTuple_GET_SIZE(color_attachments); ++i) {
+        transient = transient || ((Image *)PyTuple_GET_ITEM(color_attachments, i))->transient;
+    }
+
+    if (transient && !PyDict_Contains(self->transient_framebuffers, attachments)) {
+        PyDict_SetItem(self->transient_framebuffers, attachments, (PyObject *)framebuffer);
+        framebuffer->uses += 1;
+    }
+}
+
 Pipeline * Context_meth_pipeline(Context * self, PyObject * vargs, PyObject * kwargs) {
     static char * keywords[] = {
         "vertex_shader",
@@ -867,11 +2770,15 @@ Pipeline * Context_meth_pipeline(Context * self, PyObject * vargs, PyObject * kw
         "vertex_count",
         "instance_count",
         "first_vertex",
+        "base_vertex",
         "line_width",
         "viewport",
+        "layer",
         NULL,
     };
 
+    wait_context(self);
+
     PyObject * vertex_shader = NULL;
     PyObject * fragment_shader = NULL;
     PyObject * layout = self->module_state->empty_tuple;
@@ -888,17 +2795,19 @@ Pipeline * Context_meth_pipeline(Context * self, PyObject * vargs, PyObject * kw
     PyObject * primitive_restart = Py_True;
     PyObject * front_face = self->module_state->str_ccw;
     PyObject * cull_face = self->module_state->str_none;
-    const char * topology = "triangles";
+    PyObject * topology = NULL;
     int vertex_count = 0;
     int instance_count = 1;
     int first_vertex = 0;
+    int base_vertex = 0;
     PyObject * line_width = self->module_state->float_one;
     PyObject * viewport = Py_None;
+    int layer = 0;
 
     int args_ok = PyArg_ParseTupleAndKeywords(
         vargs,
         kwargs,
-        "|$OOOOOOOOOOOOpOOOsiiiOO",
+        "|$OOOOOOOOOOOOpOOOOiiiiOOi",
         keywords,
         &vertex_shader,
         &fragment_shader,
@@ -920,8 +2829,10 @@ Pipeline * Context_meth_pipeline(Context * self, PyObject * vargs, PyObject * kw
         &vertex_count,
         &instance_count,
         &first_vertex,
+        &base_vertex,
         &line_width,
-        &viewport
+        &viewport,
+        &layer
     );
 
     if (!args_ok) {
@@ -933,6 +2844,11 @@ Pipeline * Context_meth_pipeline(Context * self, PyObject * vargs, PyObject * kw
         return NULL;
     }
 
+    const int topology_value = topology ? lookup_enum(self->module_state->topology_table, topology) : GL_TRIANGLES;
+    if (topology_value < 0) {
+        return NULL;
+    }
+
     const GLMethods & gl = self->gl;
 
     int index_size = short_index ? 2 : 4;
@@ -943,112 +2859,66 @@ Pipeline * Context_meth_pipeline(Context * self, PyObject * vargs, PyObject * kw
         return NULL;
     }
 
-    int attribs = 0;
-    int uniforms = 0;
-    int uniform_buffers = 0;
-    gl.GetProgramiv(program->obj, GL_ACTIVE_ATTRIBUTES, &attribs);
-    gl.GetProgramiv(program->obj, GL_ACTIVE_UNIFORMS, &uniforms);
-    gl.GetProgramiv(program->obj, GL_ACTIVE_UNIFORM_BLOCKS, &uniform_buffers);
+    LayoutBinding * layout_bindings = NULL;
+    ResourceBinding resource_bindings[MAX_RESOURCES];
 
-    PyObject * program_attributes = PyList_New(attribs);
-    PyObject * program_uniforms = PyList_New(uniforms);
-    PyObject * program_uniform_buffers = PyList_New(uniform_buffers);
-
-    for (int i = 0; i < attribs; ++i) {
-        int size = 0;
-        int type = 0;
-        int length = 0;
-        char name[256] = {};
-        gl.GetActiveAttrib(program->obj, i, 256, &length, &size, (unsigned *)&type, name);
-        int location = gl.GetAttribLocation(program->obj, name);
-        PyList_SET_ITEM(program_attributes, i, Py_BuildValue("{sssi}", "name", name, "location", location));
+    const int layout_count = parse_layout(layout, &layout_bindings);
+    if (layout_count < 0) {
+        release_program(self, program);
+        Py_DECREF(program);
+        return NULL;
     }
 
-    for (int i = 0; i < uniforms; ++i) {
-        int size = 0;
-        int type = 0;
-        int length = 0;
-        char name[256] = {};
-        gl.GetActiveUniform(program->obj, i, 256, &length, &size, (unsigned *)&type, name);
-        int location = gl.GetUniformLocation(program->obj, name);
-        PyList_SET_ITEM(program_uniforms, i, Py_BuildValue("{sssi}", "name", name, "location", location));
-    }
-
-    for (int i = 0; i < uniform_buffers; ++i) {
-        int size = 0;
-        int length = 0;
-        char name[256] = {};
-        gl.GetActiveUniformBlockiv(program->obj, i, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
-        gl.GetActiveUniformBlockName(program->obj, i, 256, &length, name);
-        PyList_SET_ITEM(program_uniform_buffers, i, Py_BuildValue("{sssi}", "name", name, "size", size));
-    }
-
-    PyObject * validate = PyObject_CallMethod(
-        self->module_state->helper,
-        "validate",
-        "NNNOOO",
-        program_attributes,
-        program_uniforms,
-        program_uniform_buffers,
-        vertex_buffers,
-        layout,
-        resources
-    );
-
-    if (!validate) {
-        return NULL;
+    const int resource_count = parse_resources(resources, resource_bindings);
+    if (resource_count < 0 || !validate_pipeline(self, program->obj, vertex_buffers, layout_bindings, layout_count, resource_bindings, resource_count)) {
+        free(layout_bindings);
+        release_program(self, program);
+        Py_DECREF(program);
+        return NULL;
     }
 
     bind_program(self, program->obj);
-    int layout_count = layout != Py_None ? (int)PyList_Size(layout) : 0;
     for (int i = 0; i < layout_count; ++i) {
-        PyObject * obj = PyList_GetItem(layout, i);
-        PyObject * name = PyDict_GetItemString(obj, "name");
-        int binding = PyLong_AsLong(PyDict_GetItemString(obj, "binding"));
-        int location = gl.GetUniformLocation(program->obj, PyUnicode_AsUTF8(name));
-        if (location >= 0) {
-            gl.Uniform1i(location, binding);
+        const char * name = layout_bindings[i].name_str;
+        if (layout_bindings[i].type == SAMPLER_RESOURCE) {
+            gl.Uniform1i(gl.GetUniformLocation(program->obj, name), layout_bindings[i].binding);
         } else {
-            int index = gl.GetUniformBlockIndex(program->obj, PyUnicode_AsUTF8(name));
-            gl.UniformBlockBinding(program->obj, index, binding);
+            gl.UniformBlockBinding(program->obj, gl.GetUniformBlockIndex(program->obj, name), layout_bindings[i].binding);
         }
     }
+    free(layout_bindings);
 
-    PyObject * attachments = PyObject_CallMethod(self->module_state->helper, "framebuffer_attachments", "(O)", framebuffer_images);
+    sort_resources(resource_bindings, resource_count);
+
+    PyObject * attachments = framebuffer_attachments(self, framebuffer_images);
     if (!attachments) {
+        release_program(self, program);
+        Py_DECREF(program);
         return NULL;
     }
 
-    GLObject * framebuffer = build_framebuffer(self, attachments);
-
-    PyObject * bindings = PyObject_CallMethod(self->module_state->helper, "vertex_array_bindings", "OO", vertex_buffers, index_buffer);
+    PyObject * bindings = vertex_array_bindings(self, vertex_buffers, index_buffer);
     if (!bindings) {
+        Py_DECREF(attachments);
+        release_program(self, program);
+        Py_DECREF(program);
         return NULL;
     }
 
-    GLObject * vertex_array = build_vertex_array(self, bindings);
-    Py_DECREF(bindings);
-
-    PyObject * buffer_bindings = PyObject_CallMethod(self->module_state->helper, "buffer_bindings", "(O)", resources);
-    if (!buffer_bindings) {
-        return NULL;
-    }
-
-    DescriptorSetBuffers * descriptor_set_buffers = build_descriptor_set_buffers(self, buffer_bindings);
-    Py_DECREF(buffer_bindings);
-
-    PyObject * sampler_bindings = PyObject_CallMethod(self->module_state->helper, "sampler_bindings", "(O)", resources);
-    if (!sampler_bindings) {
+    PyObject * buffer_binding_key = buffer_bindings(resource_bindings, resource_count);
+    PyObject * sampler_binding_key = buffer_binding_key ? sampler_bindings(self, resource_bindings, resource_count) : NULL;
+    if (!sampler_binding_key) {
+        Py_XDECREF(buffer_binding_key);
+        Py_DECREF(attachments);
+        Py_DECREF(bindings);
+        release_program(self, program);
+        Py_DECREF(program);
         return NULL;
     }
 
-    DescriptorSetImages * descriptor_set_images = build_descriptor_set_images(self, sampler_bindings);
-    Py_DECREF(sampler_bindings);
-
-    PyObject * settings = PyObject_CallMethod(
-        self->module_state->helper,
-        "settings",
-        "OOOOOOOOON",
+    const int attachment_count = (int)PyTuple_Size(PyTuple_GetItem(attachments, 0));
+    PyObject * settings = pipeline_settings(
+        self,
         primitive_restart,
         line_width,
         front_face,
@@ -1058,13 +2928,32 @@ Pipeline * Context_meth_pipeline(Context * self, PyObject * vargs, PyObject * kw
         stencil,
         blending,
         polygon_offset,
-        attachments
+        attachment_count
     );
 
     if (!settings) {
+        Py_DECREF(attachments);
+        Py_DECREF(bindings);
+        Py_DECREF(buffer_binding_key);
+        Py_DECREF(sampler_binding_key);
+        release_program(self, program);
+        Py_DECREF(program);
         return NULL;
     }
 
+    GLObject * framebuffer = build_framebuffer(self, attachments);
+    pin_transient_framebuffer(self, attachments, framebuffer);
+    Py_DECREF(attachments);
+
+    GLObject * vertex_array = build_vertex_array(self, bindings);
+    Py_DECREF(bindings);
+
+    DescriptorSetBuffers * descriptor_set_buffers = build_descriptor_set_buffers(self, buffer_binding_key);
+    Py_DECREF(buffer_binding_key);
+
+    DescriptorSetImages * descriptor_set_images = build_descriptor_set_images(self, sampler_binding_key);
+    Py_DECREF(sampler_binding_key);
+
     GlobalSettings * global_settings = build_global_settings(self, settings);
     Py_DECREF(settings);
 
@@ -1086,13 +2975,21 @@ Pipeline * Context_meth_pipeline(Context * self, PyObject * vargs, PyObject * kw
     res->framebuffer = framebuffer;
     res->vertex_array = vertex_array;
     res->program = program;
-    res->topology = get_topology(topology);
+    res->topology = topology_value;
     res->vertex_count = vertex_count;
     res->instance_count = instance_count;
     res->first_vertex = first_vertex;
+    res->base_vertex = base_vertex;
     res->index_type = index_type;
     res->index_size = index_size;
+    res->layer = layer;
     res->viewport = viewport_value;
+    res->profile_queries = NULL;
+    res->profile_query_count = 0;
+    res->profile_query_capacity = 0;
+    res->gpu_time = 0;
+    res->gpu_time_count = 0;
+    res->released = false;
     res->descriptor_set_buffers = descriptor_set_buffers;
     res->descriptor_set_images = descriptor_set_images;
     res->global_settings = global_settings;
@@ -1101,6 +2998,8 @@ Pipeline * Context_meth_pipeline(Context * self, PyObject * vargs, PyObject * kw
 }
 
 PyObject * Context_meth_clear_shader_cache(Context * self) {
+    wait_context(self);
+
     const GLMethods & gl = self->gl;
     PyObject * key = NULL;
     PyObject * value = NULL;
@@ -1108,75 +3007,482 @@ PyObject * Context_meth_clear_shader_cache(Context * self) {
     while (PyDict_Next(self->shader_cache, &pos, &key, &value)) {
         GLObject * shader = (GLObject *)value;
         gl.DeleteShader(shader->obj);
+        Py_CLEAR(shader->key);
     }
     PyDict_Clear(self->shader_cache);
+    PyDict_Clear(self->source_cache);
     Py_RETURN_NONE;
 }
 
+void forget_framebuffer(Context * self, int framebuffer) {
+    if (self->current_framebuffer == framebuffer) {
+        self->current_framebuffer = -1;
+    }
+}
+
+void release_framebuffer(Context * self, GLObject * framebuffer) {
+    framebuffer->uses -= 1;
+    if (!framebuffer->uses) {
+        forget_framebuffer(self, framebuffer->obj);
+        self->gl.DeleteFramebuffers(1, (unsigned int *)&framebuffer->obj);
+        remove_dict_key(self->framebuffer_cache, &framebuffer->key);
+    }
+}
+
+int query_slot(int target) {
+    if (target == GL_TIME_ELAPSED) {
+        return 0;
+    }
+    if (target == GL_PRIMITIVES_GENERATED) {
+        return 1;
+    }
+    if (target == GL_SAMPLES_PASSED || target == GL_ANY_SAMPLES_PASSED) {
+        return 2;
+    }
+    return 3;
+}
+
+unsigned query_bit(int target) {
+    return 1u << query_slot(target);
+}
+
+int take_query(Context * self) {
+    int query = 0;
+    if (self->query_pool_count) {
+        query = self->query_pool[--self->query_pool_count];
+    } else {
+        self->gl.GenQueries(1, (unsigned *)&query);
+    }
+    return query;
+}
+
+void give_query(Context * self, int query) {
+    if (self->query_pool_count == self->query_pool_capacity) {
+        int capacity = self->query_pool_capacity ? self->query_pool_capacity * 2 : 16;
+        int * query_pool = (int *)realloc(self->query_pool, capacity * sizeof(int));
+        if (!query_pool) {
+            self->gl.DeleteQueries(1, (unsigned *)&query);
+            return;
+        }
+        self->query_pool = query_pool;
+        self->query_pool_capacity = capacity;
+    }
+    self->query_pool[self->query_pool_count++] = query;
+}
+
+void end_dropped_query(Context * self, int target) {
+    DroppedQuery & dropped = self->dropped_queries[query_slot(target)];
+    if (dropped.query) {
+        self->gl.EndQuery(dropped.target);
+        give_query(self, dropped.query);
+        dropped.query = 0;
+    }
+}
+
+void release_buffer(Context * self, Buffer * buffer) {
+    if (!buffer->buffer) {
+        return;
+    }
+    for (int i = 0; i < MAX_UNIFORM_BUFFER_BINDINGS; ++i) {
+        if (self->bound_buffers[i].buffer == buffer->buffer) {
+            self->bound_buffers[i].buffer = 0;
+        }
+    }
+    self->gl.DeleteBuffers(1, (unsigned int *)&buffer->buffer);
+    self->memory.buffers -= buffer->memory;
+    buffer->buffer = 0;
+    buffer->memory = 0;
+    Py_DECREF(buffer);
+}
+
 PyObject * Context_meth_release(Context * self, PyObject * arg) {
+    wait_context(self);
+
     const GLMethods & gl = self->gl;
     if (Py_TYPE(arg) == self->module_state->Buffer_type) {
         Buffer * buffer = (Buffer *)arg;
-        gl.DeleteBuffers(1, (unsigned int *)&buffer->buffer);
-        Py_DECREF(arg);
+        if (buffer->ring) {
+            PyErr_Format(PyExc_ValueError, "the buffer belongs to a ring buffer, release the RingBuffer instead");
+            return NULL;
+        }
+        release_buffer(self, buffer);
+    } else if (Py_TYPE(arg) == self->module_state->BufferPool_type) {
+        release_buffer(self, ((BufferPool *)arg)->buffer);
+    } else if (Py_TYPE(arg) == self->module_state->RingBuffer_type) {
+        RingBuffer * ring = (RingBuffer *)arg;
+        const Py_ssize_t index = PySequence_Index(self->ring_buffers, arg);
+        if (index < 0) {
+            PyErr_Clear();
+            Py_RETURN_NONE;
+        }
+        for (int i = 0; i < ring->frames; ++i) {
+            if (ring->fences[i]) {
+                gl.DeleteSync(ring->fences[i]);
+                ring->fences[i] = NULL;
+            }
+        }
+        if (ring->ptr) {
+            gl.BindBuffer(GL_ARRAY_BUFFER, ring->buffer->buffer);
+            gl.UnmapBuffer(GL_ARRAY_BUFFER);
+            ring->ptr = NULL;
+        }
+        PySequence_DelItem(self->ring_buffers, index);
+        ring->released = true;
+        release_buffer(self, ring->buffer);
     } else if (Py_TYPE(arg) == self->module_state->Image_type) {
         Image * image = (Image *)arg;
-        image->framebuffer->uses -= 1;
-        if (!image->framebuffer->uses) {
-            remove_dict_value(self->framebuffer_cache, (PyObject *)image->framebuffer);
-            gl.DeleteFramebuffers(1, (unsigned int *)&image->framebuffer->obj);
+        if (image->transient) {
+            PyErr_Format(PyExc_ValueError, "transient images are released by clear_transient_images");
+            return NULL;
+        }
+        if (image->mapped_buffer) {
+            gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, image->mapped_buffer->buffer);
+            gl.UnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            image->mapped_buffer->mapped = false;
+            image->mapped_buffer = NULL;
+        }
+        if (image->framebuffer) {
+            release_framebuffer(self, image->framebuffer);
         }
         if (image->renderbuffer) {
             gl.DeleteRenderbuffers(1, (unsigned int *)&image->image);
+            self->memory.renderbuffers -= image->memory;
         } else {
+            for (int i = 0; i < MAX_SAMPLER_BINDINGS; ++i) {
+                if (self->bound_images[i].image == image->image) {
+                    self->bound_images[i].image = 0;
+                }
+            }
             gl.DeleteTextures(1, (unsigned int *)&image->image);
+            self->memory.images -= image->memory;
         }
+        image->memory = 0;
         Py_DECREF(arg);
     } else if (Py_TYPE(arg) == self->module_state->Pipeline_type) {
         Pipeline * pipeline = (Pipeline *)arg;
+        if (pipeline->released) {
+            Py_RETURN_NONE;
+        }
+        pipeline->released = true;
         pipeline->descriptor_set_buffers->uses -= 1;
         if (!pipeline->descriptor_set_buffers->uses) {
-            remove_dict_value(self->descriptor_set_buffers_cache, (PyObject *)pipeline->descriptor_set_buffers);
+            if (self->current_buffers == pipeline->descriptor_set_buffers) {
+                self->current_buffers = NULL;
+            }
+            remove_dict_key(self->descriptor_set_buffers_cache, &pipeline->descriptor_set_buffers->key);
         }
         pipeline->descriptor_set_images->uses -= 1;
         if (!pipeline->descriptor_set_images->uses) {
+            if (self->current_images == pipeline->descriptor_set_images) {
+                self->current_images = NULL;
+            }
             for (int i = 0; i < pipeline->descriptor_set_images->samplers; ++i) {
                 GLObject * sampler = pipeline->descriptor_set_images->sampler[i];
                 sampler->uses -= 1;
                 if (!sampler->uses) {
-                    remove_dict_value(self->sampler_cache, (PyObject *)sampler);
+                    remove_dict_key(self->sampler_cache, &sampler->key);
+                    for (int j = 0; j < MAX_SAMPLER_BINDINGS; ++j) {
+                        if (self->bound_images[j].sampler == sampler->obj) {
+                            self->bound_images[j].sampler = 0;
+                        }
+                    }
                     gl.DeleteSamplers(1, (unsigned int *)&sampler->obj);
                 }
             }
-            remove_dict_value(self->descriptor_set_images_cache, (PyObject *)pipeline->descriptor_set_images);
+            remove_dict_key(self->descriptor_set_images_cache, &pipeline->descriptor_set_images->key);
         }
         pipeline->global_settings->uses -= 1;
         if (!pipeline->global_settings->uses) {
-            remove_dict_value(self->global_settings_cache, (PyObject *)pipeline->global_settings);
-        }
-        pipeline->framebuffer->uses -= 1;
-        if (!pipeline->framebuffer->uses) {
-            remove_dict_value(self->framebuffer_cache, (PyObject *)pipeline->framebuffer);
-            gl.DeleteFramebuffers(1, (unsigned int *)&pipeline->framebuffer->obj);
-        }
-        pipeline->program->uses -= 1;
-        if (!pipeline->program->uses) {
-            remove_dict_value(self->program_cache, (PyObject *)pipeline->program);
-            gl.DeleteProgram(pipeline->program->obj);
+            if (self->current_global_settings == pipeline->global_settings) {
+                self->current_global_settings = NULL;
+            }
+            remove_dict_key(self->global_settings_cache, &pipeline->global_settings->key);
         }
+        release_framebuffer(self, pipeline->framebuffer);
+        release_program(self, pipeline->program);
         pipeline->vertex_array->uses -= 1;
         if (!pipeline->vertex_array->uses) {
-            remove_dict_value(self->vertex_array_cache, (PyObject *)pipeline->vertex_array);
+            remove_dict_key(self->vertex_array_cache, &pipeline->vertex_array->key);
+            if (self->current_vertex_array == pipeline->vertex_array->obj) {
+                self->current_vertex_array = -1;
+            }
             gl.DeleteVertexArrays(1, (unsigned int *)&pipeline->vertex_array->obj);
         }
+        for (int i = 0; i < pipeline->profile_query_count; ++i) {
+            give_query(self, pipeline->profile_queries[i]);
+        }
+        pipeline->profile_query_count = 0;
         Py_DECREF(pipeline);
+    } else if (Py_TYPE(arg) == self->module_state->Query_type) {
+        Query * query = (Query *)arg;
+        if (!query->query) {
+            Py_RETURN_NONE;
+        }
+        if (query->active) {
+            gl.EndQuery(query->target);
+            self->active_queries &= ~query_bit(query->target);
+        }
+        give_query(self, query->query);
+        query->query = 0;
+        query->active = false;
+        query->issued = false;
+    } else if (Py_TYPE(arg) == self->module_state->Fence_type) {
+        Fence * fence = (Fence *)arg;
+        if (fence->sync) {
+            gl.DeleteSync(fence->sync);
+            fence->sync = NULL;
+        }
+        fence->released = true;
+    }
+    Py_RETURN_NONE;
+}
+
+PyObject * Context_meth_release_many(Context * self, PyObject * arg) {
+    PyObject * seq = PySequence_Fast(arg, "release_many expects a list of objects");
+    if (!seq) {
+        return NULL;
+    }
+
+    const int count = (int)PySequence_Fast_GET_SIZE(seq);
+    PyObject ** items = PySequence_Fast_ITEMS(seq);
+
+    for (int i = 0; i < count; ++i) {
+        PyObject * res = Context_meth_release(self, items[i]);
+        if (!res) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+        Py_DECREF(res);
+    }
+
+    Py_DECREF(seq);
+    Py_RETURN_NONE;
+}
+
+int next_program_build(Context * self, ProgramBuild * builds, int count) {
+    int first = -1;
+    for (int i = 0; i < count; ++i) {
+        if (!builds[i].key) {
+            continue;
+        }
+        if (first < 0) {
+            first = i;
+        }
+        if (!self->parallel_shader_compile) {
+            break;
+        }
+        int completed = false;
+        self->gl.GetProgramiv(builds[i].program->obj, GL_COMPLETION_STATUS, &completed);
+        if (completed) {
+            return i;
+        }
+    }
+    return first;
+}
+
+PyObject * Context_meth_pipelines(Context * self, PyObject * arg) {
+    wait_context(self);
+
+    PyObject * seq = PySequence_Fast(arg, "pipelines expects a list of dicts");
+    if (!seq) {
+        return NULL;
+    }
+
+    const int count = (int)PySequence_Fast_GET_SIZE(seq);
+    PyObject ** items = PySequence_Fast_ITEMS(seq);
+
+    for (int i = 0; i < count; ++i) {
+        if (!PyDict_Check(items[i])) {
+            PyErr_Format(PyExc_TypeError, "pipelines expects a list of dicts");
+            Py_DECREF(seq);
+            return NULL;
+        }
+    }
+
+    ProgramBuild * builds = (ProgramBuild *)malloc(count * sizeof(ProgramBuild) + 1);
+    PyObject * pending = PyDict_New();
+    int build_count = 0;
+
+    for (int i = 0; i < count && !PyErr_Occurred(); ++i) {
+        PyObject * vertex_shader = PyDict_GetItemString(items[i], "vertex_shader");
+        PyObject * fragment_shader = PyDict_GetItemString(items[i], "fragment_shader");
+        PyObject * layout = PyDict_GetItemString(items[i], "layout");
+        if (!vertex_shader || !fragment_shader) {
+            continue;
+        }
+        PyObject * key = preprocess_program(self, vertex_shader, fragment_shader, layout ? layout : self->module_state->empty_tuple);
+        if (!key) {
+            break;
+        }
+        if (PyDict_Contains(self->program_cache, key) || PyDict_Contains(pending, key)) {
+            Py_DECREF(key);
+            continue;
+        }
+        PyDict_SetItem(pending, key, Py_None);
+        self->stats.program_cache.misses += 1;
+        begin_program(self, key, &builds[build_count++]);
+    }
+
+    Py_DECREF(pending);
+
+    PyObject * built = PyDict_New();
+
+    for (int i = 0; i < build_count; ++i) {
+        const int index = next_program_build(self, builds, build_count);
+        PyObject * key = builds[index].key;
+        Py_INCREF(key);
+        if (finish_program(self, &builds[index], !PyErr_Occurred())) {
+            builds[index].program->uses = 0;
+            PyDict_SetItem(built, key, (PyObject *)builds[index].program);
+            Py_DECREF(builds[index].program);
+        }
+        Py_DECREF(key);
+        builds[index].key = NULL;
+    }
+
+    free(builds);
+
+    PyObject * res = PyErr_Occurred() ? NULL : PyList_New(count);
+    for (int i = 0; res && i < count; ++i) {
+        Pipeline * pipeline = Context_meth_pipeline(self, self->module_state->empty_tuple, items[i]);
+        if (!pipeline) {
+            for (int j = 0; j < i; ++j) {
+                Py_DECREF(Context_meth_release(self, PyList_GET_ITEM(res, j)));
+            }
+            Py_CLEAR(res);
+            break;
+        }
+        PyList_SET_ITEM(res, i, (PyObject *)pipeline);
+    }
+
+    if (!res) {
+        PyObject * key = NULL;
+        PyObject * value = NULL;
+        Py_ssize_t pos = 0;
+        while (PyDict_Next(built, &pos, &key, &value)) {
+            GLObject * program = (GLObject *)value;
+            if (program->key && !program->uses) {
+                self->gl.DeleteProgram(program->obj);
+                remove_dict_key(self->program_cache, &program->key);
+            }
+        }
+    }
+
+    Py_DECREF(built);
+    Py_DECREF(seq);
+    return res;
+}
+
+unsigned long long pointer_bits(void * ptr, int bits) {
+    return ((unsigned long long)(size_t)ptr >> 4) & ((1ull << bits) - 1);
+}
+
+unsigned long long pipeline_sort_key(Pipeline * pipeline) {
+    long long layer = pipeline->layer;
+    layer = layer < -0x8000 ? -0x8000 : layer > 0x7fff ? 0x7fff : layer;
+    unsigned long long key = (unsigned long long)(layer + 0x8000) << 48;
+    if (pipeline->global_settings->blend_enable) {
+        return key | 1ull << 47;
+    }
+    key |= (unsigned long long)(pipeline->framebuffer->obj & 0x3ff) << 37;
+    key |= (unsigned long long)(pipeline->program->obj & 0xfff) << 25;
+    key |= pointer_bits(pipeline->global_settings, 10) << 15;
+    key |= (unsigned long long)(pipeline->vertex_array->obj & 0x3ff) << 5;
+    key |= pointer_bits(pipeline->descriptor_set_images, 3) << 2;
+    key |= pointer_bits(pipeline->descriptor_set_buffers, 2);
+    return key;
+}
+
+int compare_sort_items(const void * a, const void * b) {
+    const SortItem * lhs = (const SortItem *)a;
+    const SortItem * rhs = (const SortItem *)b;
+    if (lhs->key != rhs->key) {
+        return lhs->key < rhs->key ? -1 : 1;
+    }
+    return lhs->index - rhs->index;
+}
+
+PyObject * Context_meth_render(Context * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"pipelines", "sort", NULL};
+
+    wait_context(self);
+
+    PyObject * arg;
+    int sort = false;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "O|$p", keywords, &arg, &sort)) {
+        return NULL;
+    }
+
+    PyObject * pipelines = PySequence_Fast(arg, "pipelines must be an iterable of pipelines");
+    if (!pipelines) {
+        return NULL;
+    }
+
+    int count = (int)PySequence_Fast_GET_SIZE(pipelines);
+    PyObject ** seq = PySequence_Fast_ITEMS(pipelines);
+
+    for (int i = 0; i < count; ++i) {
+        if (Py_TYPE(seq[i]) != self->module_state->Pipeline_type || ((Pipeline *)seq[i])->ctx != self) {
+            Py_DECREF(pipelines);
+            PyErr_Format(PyExc_TypeError, "pipelines[%d] is not a Pipeline of this context", i);
+            return NULL;
+        }
+    }
+
+    if (self->mapped_buffers) {
+        Py_DECREF(pipelines);
+        PyErr_Format(PyExc_RuntimeError, "rendering with mapped buffers");
+        return NULL;
     }
+
+    if (sort && count > 1) {
+        SortItem * items = (SortItem *)malloc(count * sizeof(SortItem));
+        if (!items) {
+            Py_DECREF(pipelines);
+            return PyErr_NoMemory();
+        }
+        for (int i = 0; i < count; ++i) {
+            items[i].key = pipeline_sort_key((Pipeline *)seq[i]);
+            items[i].index = i;
+        }
+        qsort(items, count, sizeof(SortItem), compare_sort_items);
+        for (int i = 0; i < count; ++i) {
+            render_pipeline((Pipeline *)seq[items[i].index]);
+        }
+        free(items);
+    } else {
+        for (int i = 0; i < count; ++i) {
+            render_pipeline((Pipeline *)seq[i]);
+        }
+    }
+
+    Py_DECREF(pipelines);
     Py_RETURN_NONE;
 }
 
+PyObject * Context_meth_invalidate_state(Context * self) {
+    wait_context(self);
+
+    reset_context_state(self);
+    Py_RETURN_NONE;
+}
+
+void write_buffer(Buffer * self, int offset, int size, const void * data) {
+    const GLMethods & gl = self->ctx->gl;
+    gl.BindBuffer(GL_ARRAY_BUFFER, self->buffer);
+    PyThreadState * state = begin_allow_threads(self->ctx, size);
+    gl.BufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    end_allow_threads(self->ctx, state);
+    self->ctx->stats.bytes_uploaded += size;
+}
+
 PyObject * Buffer_meth_write(Buffer * self, PyObject * vargs, PyObject * kwargs) {
     static char * keywords[] = {"data", "offset", NULL};
 
+    wait_context(self->ctx);
+
     Py_buffer view;
     int offset = 0;
 
@@ -1186,11 +3492,13 @@ PyObject * Buffer_meth_write(Buffer * self, PyObject * vargs, PyObject * kwargs)
 
     const bool already_mapped = self->mapped;
     const bool invalid_offset = offset < 0 || offset > self->size;
-    const bool invalid_size = (int)view.len > self->size;
+    const bool invalid_size = (int)view.len > self->size - offset;
 
-    if (already_mapped || invalid_offset || invalid_size) {
+    if (self->ring || already_mapped || invalid_offset || invalid_size) {
         PyBuffer_Release(&view);
-        if (already_mapped) {
+        if (self->ring) {
+            PyErr_Format(PyExc_TypeError, "ring buffers must be written with RingBuffer.write");
+        } else if (already_mapped) {
             PyErr_Format(PyExc_RuntimeError, "already mapped");
         } else if (invalid_offset) {
             PyErr_Format(PyExc_ValueError, "invalid offset");
@@ -1200,18 +3508,78 @@ PyObject * Buffer_meth_write(Buffer * self, PyObject * vargs, PyObject * kwargs)
         return NULL;
     }
 
-    const GLMethods & gl = self->ctx->gl;
+    write_buffer(self, offset, (int)view.len, view.buf);
+    PyBuffer_Release(&view);
+    Py_RETURN_NONE;
+}
 
-    gl.BindBuffer(GL_ARRAY_BUFFER, self->buffer);
-    gl.BufferSubData(GL_ARRAY_BUFFER, offset, (int)view.len, view.buf);
+PyObject * Buffer_meth_copy_to(Buffer * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"other", "src_offset", "dst_offset", "size", NULL};
 
-    PyBuffer_Release(&view);
+    wait_context(self->ctx);
+
+    Buffer * other;
+    int src_offset = 0;
+    int dst_offset = 0;
+    PyObject * size_arg = Py_None;
+
+    int args_ok = PyArg_ParseTupleAndKeywords(
+        vargs,
+        kwargs,
+        "O!|iiO",
+        keywords,
+        self->ctx->module_state->Buffer_type,
+        &other,
+        &src_offset,
+        &dst_offset,
+        &size_arg
+    );
+
+    if (!args_ok) {
+        return NULL;
+    }
+
+    const bool invalid_size_type = size_arg != Py_None && !PyLong_CheckExact(size_arg);
+    const int size = size_arg != Py_None && !invalid_size_type ? PyLong_AsLong(size_arg) : self->size - src_offset;
+
+    const bool invalid_context = other->ctx != self->ctx;
+    const bool mapped = self->mapped || other->mapped;
+    const bool invalid_src_offset = src_offset < 0 || src_offset > self->size;
+    const bool invalid_dst_offset = dst_offset < 0 || dst_offset > other->size;
+    const bool invalid_size = size <= 0 || size > self->size - src_offset || size > other->size - dst_offset;
+    const bool overlapping = other == self && src_offset < dst_offset + size && dst_offset < src_offset + size;
+
+    if (invalid_size_type || invalid_context || mapped || invalid_src_offset || invalid_dst_offset || invalid_size || overlapping) {
+        if (invalid_size_type) {
+            PyErr_Format(PyExc_TypeError, "the size must be an int or None");
+        } else if (invalid_context) {
+            PyErr_Format(PyExc_ValueError, "the other buffer belongs to a different context");
+        } else if (mapped) {
+            PyErr_Format(PyExc_RuntimeError, "cannot copy mapped buffers");
+        } else if (invalid_src_offset) {
+            PyErr_Format(PyExc_ValueError, "invalid src_offset");
+        } else if (invalid_dst_offset) {
+            PyErr_Format(PyExc_ValueError, "invalid dst_offset");
+        } else if (invalid_size) {
+            PyErr_Format(PyExc_ValueError, "invalid size");
+        } else if (overlapping) {
+            PyErr_Format(PyExc_ValueError, "the source and destination ranges overlap");
+        }
+        return NULL;
+    }
+
+    const GLMethods & gl = self->ctx->gl;
+    gl.BindBuffer(GL_COPY_READ_BUFFER, self->buffer);
+    gl.BindBuffer(GL_COPY_WRITE_BUFFER, other->buffer);
+    gl.CopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, self->frame_offset + src_offset, other->frame_offset + dst_offset, size);
     Py_RETURN_NONE;
 }
 
 PyObject * Buffer_meth_map(Buffer * self, PyObject * vargs, PyObject * kwargs) {
     static char * keywords[] = {"size", "offset", "discard", NULL};
 
+    wait_context(self->ctx);
+
     PyObject * size_arg = Py_None;
     PyObject * offset_arg = Py_None;
     int discard = false;
@@ -1239,8 +3607,10 @@ PyObject * Buffer_meth_map(Buffer * self, PyObject * vargs, PyObject * kwargs) {
     const bool invalid_size = invalid_size_type || size <= 0 || size > self->size;
     const bool invalid_offset = invalid_offset_type || offset < 0 || offset + size > self->size;
 
-    if (already_mapped || offset_but_no_size || invalid_size || invalid_offset) {
-        if (already_mapped) {
+    if (self->ring || already_mapped || offset_but_no_size || invalid_size || invalid_offset) {
+        if (self->ring) {
+            PyErr_Format(PyExc_TypeError, "ring buffers must be written with RingBuffer.write");
+        } else if (already_mapped) {
             PyErr_Format(PyExc_RuntimeError, "already mapped");
         } else if (offset_but_no_size) {
             PyErr_Format(PyExc_ValueError, "the size is required when the offset is not None");
@@ -1267,6 +3637,8 @@ PyObject * Buffer_meth_map(Buffer * self, PyObject * vargs, PyObject * kwargs) {
 }
 
 PyObject * Buffer_meth_unmap(Buffer * self) {
+    wait_context(self->ctx);
+
     const GLMethods & gl = self->ctx->gl;
     if (self->mapped) {
         self->mapped = false;
@@ -1277,12 +3649,13 @@ PyObject * Buffer_meth_unmap(Buffer * self) {
     Py_RETURN_NONE;
 }
 
-PyObject * Image_meth_clear(Image * self) {
+void clear_image(Image * self) {
     const GLMethods & gl = self->ctx->gl;
     bind_framebuffer(self->ctx, self->framebuffer->obj);
-    gl.ColorMaski(0, 1, 1, 1, 1);
-    gl.DepthMask(1);
-    gl.StencilMaskSeparate(GL_FRONT, 0xff);
+    self->ctx->current_global_settings = NULL;
+    set_color_mask(self->ctx, 0, 0xf);
+    set_depth_write(self->ctx, 1);
+    set_stencil_write_mask(self->ctx, 0xff);
     if (self->format.clear_type == 'f') {
         gl.ClearBufferfv(self->format.buffer, 0, self->clear_value.clear_floats);
     } else if (self->format.clear_type == 'i') {
@@ -1292,26 +3665,27 @@ PyObject * Image_meth_clear(Image * self) {
     } else if (self->format.clear_type == 'x') {
         gl.ClearBufferfi(self->format.buffer, 0, self->clear_value.clear_floats[0], self->clear_value.clear_ints[1]);
     }
-    if (GlobalSettings * settings = self->ctx->current_global_settings) {
-        gl.ColorMaski(0, settings->color_mask & 1, settings->color_mask & 2, settings->color_mask & 4, settings->color_mask & 8);
-        gl.StencilMaskSeparate(GL_FRONT, settings->stencil_front.write_mask);
-        gl.DepthMask(settings->depth_write);
-    }
-    Py_RETURN_NONE;
 }
 
-PyObject * Image_meth_write(Image * self, PyObject * vargs, PyObject * kwargs) {
-    static char * keywords[] = {"data", "size", "offset", "layer", NULL};
+bool check_clear(Image * self) {
+    if (!self->framebuffer) {
+        PyErr_Format(PyExc_TypeError, "cannot clear cubemap or array images");
+        return false;
+    }
+    return true;
+}
 
-    Py_buffer view;
-    PyObject * size_arg = Py_None;
-    PyObject * offset_arg = Py_None;
-    PyObject * layer_arg = Py_None;
+PyObject * Image_meth_clear(Image * self) {
+    wait_context(self->ctx);
 
-    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "y*|O$OO", keywords, &view, &size_arg, &offset_arg, &layer_arg)) {
+    if (!check_clear(self)) {
         return NULL;
     }
+    clear_image(self);
+    Py_RETURN_NONE;
+}
 
+bool parse_region(Image * self, PyObject * size_arg, PyObject * offset_arg, PyObject * layer_arg, ImageRegion * region) {
     IntPair size = {};
     IntPair offset = {};
     int layer = 0;
@@ -1343,7 +3717,6 @@ PyObject * Image_meth_write(Image * self, PyObject * vargs, PyObject * kwargs) {
     const bool invalid_type = !self->format.color || self->samples != 1;
 
     if (offset_but_no_size || invalid_size || invalid_offset || invalid_layer || layer_but_simple || invalid_type) {
-        PyBuffer_Release(&view);
         if (offset_but_no_size) {
             PyErr_Format(PyExc_ValueError, "the size is required when the offset is not None");
         } else if (invalid_size_type) {
@@ -1365,49 +3738,233 @@ PyObject * Image_meth_write(Image * self, PyObject * vargs, PyObject * kwargs) {
         } else if (self->samples != 1) {
             PyErr_Format(PyExc_TypeError, "cannot write to multisampled images");
         }
-        return NULL;
+        return false;
     }
 
-    const GLMethods & gl = self->ctx->gl;
+    region->size = size;
+    region->offset = offset;
+    region->layer = layer;
+    return true;
+}
 
-    gl.ActiveTexture(self->ctx->default_texture_unit);
-    gl.BindTexture(self->target, self->image);
+void upload_image(Image * self, const ImageRegion & region, const void * data) {
+    const GLMethods & gl = self->ctx->gl;
+    const IntPair & size = region.size;
+    const IntPair & offset = region.offset;
     if (self->cubemap) {
-        int face = GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer;
-        gl.TexSubImage2D(face, 0, offset.x, offset.y, size.x, size.y, self->format.format, self->format.type, view.buf);
+        int face = GL_TEXTURE_CUBE_MAP_POSITIVE_X + region.layer;
+        gl.TexSubImage2D(face, 0, offset.x, offset.y, size.x, size.y, self->format.format, self->format.type, data);
     } else if (self->array) {
-        gl.TexSubImage3D(self->target, 0, offset.x, offset.y, layer, size.x, size.y, 1, self->format.format, self->format.type, view.buf);
+        gl.TexSubImage3D(self->target, 0, offset.x, offset.y, region.layer, size.x, size.y, 1, self->format.format, self->format.type, data);
     } else {
-        gl.TexSubImage2D(self->target, 0, offset.x, offset.y, size.x, size.y, self->format.format, self->format.type, view.buf);
+        gl.TexSubImage2D(self->target, 0, offset.x, offset.y, size.x, size.y, self->format.format, self->format.type, data);
     }
-
-    PyBuffer_Release(&view);
-    Py_RETURN_NONE;
 }
 
-PyObject * Image_meth_mipmaps(Image * self, PyObject * vargs, PyObject * kwargs) {
-    static char * keywords[] = {"base", "levels", NULL};
-
-    int base = 0;
-    PyObject * levels_arg = Py_None;
+PixelBuffer * take_unpack_buffer(Context * self, int size) {
+    const GLMethods & gl = self->gl;
+    PixelBuffer * res = NULL;
+    for (int i = 0; i < UNPACK_RING_SIZE && !res; ++i) {
+        PixelBuffer * pixel_buffer = &self->unpack_buffers[self->unpack_index];
+        self->unpack_index = (self->unpack_index + 1) % UNPACK_RING_SIZE;
+        if (!pixel_buffer->mapped) {
+            res = pixel_buffer;
+        }
+    }
 
-    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "|$iO", keywords, &base, &levels_arg)) {
+    if (!res) {
+        PyErr_Format(PyExc_RuntimeError, "too many mapped images");
         return NULL;
     }
 
-    int max_levels = count_mipmaps(self->width, self->height);
+    if (res->fence) {
+        int status = gl.ClientWaitSync(res->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            PyThreadState * state = release_context(self);
+            gl.ClientWaitSync(res->fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            end_allow_threads(self, state);
+        }
+        gl.DeleteSync(res->fence);
+        res->fence = NULL;
+    }
 
-    const bool invalid_levels_type = levels_arg != Py_None && !PyLong_CheckExact(levels_arg);
+    if (!res->buffer) {
+        gl.GenBuffers(1, (unsigned *)&res->buffer);
+    }
 
-    int levels = max_levels - base;
-    if (levels_arg != Py_None && !invalid_levels_type) {
-        levels = PyLong_AsLong(levels_arg);
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, res->buffer);
+    if (res->size < size) {
+        gl.BufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        self->memory.staging += size - res->size;
+        res->size = size;
     }
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return res;
+}
 
-    const bool invalid_base = base < 0 || base >= max_levels;
-    const bool invalid_levels = levels <= 0 || base + levels > max_levels;
+void upload_unpack_buffer(Image * self, PixelBuffer * pixel_buffer, const ImageRegion & region) {
+    const GLMethods & gl = self->ctx->gl;
+    bind_default_texture(self->ctx, self->target, self->image);
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer->buffer);
+    upload_image(self, region, NULL);
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    self->ctx->stats.bytes_uploaded += region.size.x * region.size.y * self->format.pixel_size;
+    pixel_buffer->fence = gl.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
 
-    if (invalid_levels_type || invalid_base || invalid_levels) {
+PyObject * Image_meth_write(Image * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"data", "size", "offset", "layer", "async_", NULL};
+
+    wait_context(self->ctx);
+
+    Py_buffer view;
+    PyObject * size_arg = Py_None;
+    PyObject * offset_arg = Py_None;
+    PyObject * layer_arg = Py_None;
+    int async = false;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "y*|O$OOp", keywords, &view, &size_arg, &offset_arg, &layer_arg, &async)) {
+        return NULL;
+    }
+
+    ImageRegion region = {};
+    if (!parse_region(self, size_arg, offset_arg, layer_arg, &region)) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    const int data_size = region.size.x * region.size.y * self->format.pixel_size;
+    if (view.len < data_size) {
+        PyBuffer_Release(&view);
+        PyErr_Format(PyExc_ValueError, "not enough data for the given size");
+        return NULL;
+    }
+
+    const GLMethods & gl = self->ctx->gl;
+
+    if (async) {
+        PixelBuffer * pixel_buffer = take_unpack_buffer(self->ctx, data_size);
+        if (!pixel_buffer) {
+            PyBuffer_Release(&view);
+            return NULL;
+        }
+        gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer->buffer);
+        void * ptr = gl.MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, data_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (!ptr) {
+            gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            PyBuffer_Release(&view);
+            PyErr_Format(PyExc_RuntimeError, "cannot map the pixel buffer");
+            return NULL;
+        }
+        PyThreadState * state = begin_allow_threads(self->ctx, data_size);
+        memcpy(ptr, view.buf, data_size);
+        end_allow_threads(self->ctx, state);
+        gl.UnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        upload_unpack_buffer(self, pixel_buffer, region);
+        PyBuffer_Release(&view);
+        Py_RETURN_NONE;
+    }
+
+    bind_default_texture(self->ctx, self->target, self->image);
+    PyThreadState * state = begin_allow_threads(self->ctx, view.len);
+    upload_image(self, region, view.buf);
+    end_allow_threads(self->ctx, state);
+    self->ctx->stats.bytes_uploaded += data_size;
+
+    PyBuffer_Release(&view);
+    Py_RETURN_NONE;
+}
+
+PyObject * Image_meth_map(Image * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"size", "offset", "layer", NULL};
+
+    wait_context(self->ctx);
+
+    PyObject * size_arg = Py_None;
+    PyObject * offset_arg = Py_None;
+    PyObject * layer_arg = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "|O$OO", keywords, &size_arg, &offset_arg, &layer_arg)) {
+        return NULL;
+    }
+
+    if (self->mapped_buffer) {
+        PyErr_Format(PyExc_RuntimeError, "already mapped");
+        return NULL;
+    }
+
+    ImageRegion region = {};
+    if (!parse_region(self, size_arg, offset_arg, layer_arg, &region)) {
+        return NULL;
+    }
+
+    const int data_size = region.size.x * region.size.y * self->format.pixel_size;
+    PixelBuffer * pixel_buffer = take_unpack_buffer(self->ctx, data_size);
+    if (!pixel_buffer) {
+        return NULL;
+    }
+
+    const GLMethods & gl = self->ctx->gl;
+
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer->buffer);
+    void * ptr = gl.MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, data_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!ptr) {
+        PyErr_Format(PyExc_RuntimeError, "cannot map the pixel buffer");
+        return NULL;
+    }
+    pixel_buffer->mapped = true;
+    self->mapped_buffer = pixel_buffer;
+    self->mapped_region = region;
+    return PyMemoryView_FromMemory((char *)ptr, data_size, PyBUF_WRITE);
+}
+
+PyObject * Image_meth_unmap(Image * self) {
+    wait_context(self->ctx);
+
+    if (!self->mapped_buffer) {
+        PyErr_Format(PyExc_RuntimeError, "not mapped");
+        return NULL;
+    }
+
+    const GLMethods & gl = self->ctx->gl;
+
+    PixelBuffer * pixel_buffer = self->mapped_buffer;
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer->buffer);
+    gl.UnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    upload_unpack_buffer(self, pixel_buffer, self->mapped_region);
+    pixel_buffer->mapped = false;
+    self->mapped_buffer = NULL;
+    Py_RETURN_NONE;
+}
+
+PyObject * Image_meth_mipmaps(Image * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"base", "levels", NULL};
+
+    wait_context(self->ctx);
+
+    int base = 0;
+    PyObject * levels_arg = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "|$iO", keywords, &base, &levels_arg)) {
+        return NULL;
+    }
+
+    int max_levels = count_mipmaps(self->width, self->height);
+
+    const bool invalid_levels_type = levels_arg != Py_None && !PyLong_CheckExact(levels_arg);
+
+    int levels = max_levels - base;
+    if (levels_arg != Py_None && !invalid_levels_type) {
+        levels = PyLong_AsLong(levels_arg);
+    }
+
+    const bool invalid_base = base < 0 || base >= max_levels;
+    const bool invalid_levels = levels <= 0 || base + levels > max_levels;
+
+    if (invalid_levels_type || invalid_base || invalid_levels) {
         if (invalid_levels_type) {
             PyErr_Format(PyExc_TypeError, "levels must be an int");
         } else if (invalid_base) {
@@ -1418,44 +3975,51 @@ PyObject * Image_meth_mipmaps(Image * self, PyObject * vargs, PyObject * kwargs)
         return NULL;
     }
 
+    const int layers = (self->array ? self->array : 1) * (self->cubemap ? 6 : 1);
+    const long long memory = image_memory(self->width, self->height, layers, self->format.pixel_size, base + levels + 1);
+    if (memory > self->memory) {
+        if (!reserve_memory(self->ctx, "image", memory - self->memory)) {
+            return NULL;
+        }
+        self->ctx->memory.images += memory - self->memory;
+        self->memory = memory;
+    }
+
     const GLMethods & gl = self->ctx->gl;
-    gl.BindTexture(self->target, self->image);
+    bind_default_texture(self->ctx, self->target, self->image);
     gl.TexParameteri(self->target, GL_TEXTURE_BASE_LEVEL, base);
     gl.TexParameteri(self->target, GL_TEXTURE_MAX_LEVEL, base + levels);
     gl.GenerateMipmap(self->target);
     Py_RETURN_NONE;
 }
 
-PyObject * Image_meth_read(Image * self, PyObject * vargs, PyObject * kwargs) {
+bool parse_read(Image * self, PyObject * vargs, PyObject * kwargs, IntPair * size, IntPair * offset) {
     static char * keywords[] = {"size", "offset", NULL};
 
     PyObject * size_arg = Py_None;
     PyObject * offset_arg = Py_None;
 
     if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "|O$O", keywords, &size_arg, &offset_arg)) {
-        return NULL;
+        return false;
     }
 
-    IntPair size = {};
-    IntPair offset = {};
-
     const bool invalid_size_type = size_arg != Py_None && !is_int_pair(size_arg);
     const bool invalid_offset_type = offset_arg != Py_None && !is_int_pair(offset_arg);
 
     if (size_arg != Py_None && !invalid_size_type) {
-        size = to_int_pair(size_arg);
+        *size = to_int_pair(size_arg);
     } else {
-        size.x = self->width;
-        size.y = self->height;
+        size->x = self->width;
+        size->y = self->height;
     }
 
     if (offset_arg != Py_None && !invalid_offset_type) {
-        offset = to_int_pair(offset_arg);
+        *offset = to_int_pair(offset_arg);
     }
 
     const bool offset_but_no_size = size_arg == Py_None && offset_arg != Py_None;
-    const bool invalid_size = invalid_size_type || size.x <= 0 || size.y <= 0 || size.x > self->width || size.y > self->height;
-    const bool invalid_offset = invalid_offset_type || offset.x < 0 || offset.y < 0 || size.x + offset.x > self->width || size.y + offset.y > self->height;
+    const bool invalid_size = invalid_size_type || size->x <= 0 || size->y <= 0 || size->x > self->width || size->y > self->height;
+    const bool invalid_offset = invalid_offset_type || offset->x < 0 || offset->y < 0 || size->x + offset->x > self->width || size->y + offset->y > self->height;
     const bool invalid_type = self->cubemap || self->array || self->samples != 1;
 
     if (offset_but_no_size || invalid_size || invalid_offset || invalid_type) {
@@ -1476,6 +4040,18 @@ PyObject * Image_meth_read(Image * self, PyObject * vargs, PyObject * kwargs) {
         } else if (self->samples != 1) {
             PyErr_Format(PyExc_TypeError, "multisampled images must be blit to a non multisampled image before read");
         }
+        return false;
+    }
+
+    return true;
+}
+
+PyObject * Image_meth_read(Image * self, PyObject * vargs, PyObject * kwargs) {
+    wait_context(self->ctx);
+
+    IntPair size = {};
+    IntPair offset = {};
+    if (!parse_read(self, vargs, kwargs, &size, &offset)) {
         return NULL;
     }
 
@@ -1483,250 +4059,2146 @@ PyObject * Image_meth_read(Image * self, PyObject * vargs, PyObject * kwargs) {
 
     PyObject * res = PyBytes_FromStringAndSize(NULL, size.x * size.y * self->format.pixel_size);
     bind_framebuffer(self->ctx, self->framebuffer->obj);
+    PyThreadState * state = begin_allow_threads(self->ctx, PyBytes_GET_SIZE(res));
     gl.ReadPixels(offset.x, offset.y, size.x, size.y, self->format.format, self->format.type, PyBytes_AS_STRING(res));
+    end_allow_threads(self->ctx, state);
+    self->ctx->stats.bytes_read += PyBytes_GET_SIZE(res);
     return res;
 }
 
-PyObject * Image_meth_blit(Image * self, PyObject * vargs, PyObject * kwargs) {
-    static char * keywords[] = {"target", "target_viewport", "source_viewport", "filter", "srgb", NULL};
+PixelBuffer take_pixel_buffer(Context * self, int size) {
+    const GLMethods & gl = self->gl;
+    PixelBuffer res = {};
+    int index = -1;
+    for (int i = 0; i < self->pixel_buffer_count; ++i) {
+        if (self->pixel_buffers[i].size >= size) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0 && self->pixel_buffer_count) {
+        index = self->pixel_buffer_count - 1;
+    }
+    if (index >= 0) {
+        res = self->pixel_buffers[index];
+        self->pixel_buffers[index] = self->pixel_buffers[--self->pixel_buffer_count];
+    } else {
+        gl.GenBuffers(1, (unsigned *)&res.buffer);
+    }
+    if (res.fence) {
+        gl.DeleteSync(res.fence);
+        res.fence = NULL;
+    }
+    if (res.size < size) {
+        gl.BindBuffer(GL_PIXEL_PACK_BUFFER, res.buffer);
+        gl.BufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        self->memory.staging += size - res.size;
+        res.size = size;
+    }
+    return res;
+}
 
-    PyObject * target_arg = Py_None;
-    PyObject * target_viewport_arg = Py_None;
-    PyObject * source_viewport_arg = Py_None;
-    int filter = true;
-    int srgb = false;
+void give_pixel_buffer(Context * self, const PixelBuffer & pixel_buffer) {
+    if (self->pixel_buffer_count == self->pixel_buffer_capacity) {
+        int capacity = self->pixel_buffer_capacity ? self->pixel_buffer_capacity * 2 : 4;
+        PixelBuffer * pixel_buffers = (PixelBuffer *)realloc(self->pixel_buffers, capacity * sizeof(PixelBuffer));
+        if (!pixel_buffers) {
+            return;
+        }
+        self->pixel_buffers = pixel_buffers;
+        self->pixel_buffer_capacity = capacity;
+    }
+    self->pixel_buffers[self->pixel_buffer_count++] = pixel_buffer;
+}
 
-    int args_ok = PyArg_ParseTupleAndKeywords(
-        vargs,
-        kwargs,
-        "|OO$Opp",
-        keywords,
-        &target_arg,
-        &target_viewport_arg,
-        &source_viewport_arg,
-        &filter,
-        &srgb
-    );
+AsyncRead * Image_meth_read_async(Image * self, PyObject * vargs, PyObject * kwargs) {
+    wait_context(self->ctx);
 
-    if (!args_ok) {
+    IntPair size = {};
+    IntPair offset = {};
+    if (!parse_read(self, vargs, kwargs, &size, &offset)) {
         return NULL;
     }
 
-    const bool invalid_target_type = target_arg != Py_None && Py_TYPE(target_arg) != self->ctx->module_state->Image_type;
-
-    Image * target = target_arg != Py_None && !invalid_target_type ? (Image *)target_arg : NULL;
+    const GLMethods & gl = self->ctx->gl;
 
-    Viewport target_viewport = {};
-    Viewport source_viewport = {};
+    const int data_size = size.x * size.y * self->format.pixel_size;
+    PixelBuffer pixel_buffer = take_pixel_buffer(self->ctx, data_size);
+    bind_framebuffer(self->ctx, self->framebuffer->obj);
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer.buffer);
+    gl.ReadPixels(offset.x, offset.y, size.x, size.y, self->format.format, self->format.type, NULL);
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    pixel_buffer.fence = gl.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    AsyncRead * res = PyObject_New(AsyncRead, self->ctx->module_state->AsyncRead_type);
+    res->ctx = (Context *)new_ref(self->ctx);
+    res->result = NULL;
+    res->pixel_buffer = pixel_buffer;
+    res->size = data_size;
+    return res;
+}
 
-    const bool invalid_target_viewport_type = target_viewport_arg != Py_None && !is_viewport(target_viewport_arg);
-    const bool invalid_source_viewport_type = source_viewport_arg != Py_None && !is_viewport(source_viewport_arg);
+bool client_wait_sync(Context * self, void * sync, unsigned long long timeout) {
+    PyThreadState * state = timeout ? release_context(self) : NULL;
+    int status = self->gl.ClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    end_allow_threads(self, state);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
 
-    if (target_viewport_arg != Py_None && !invalid_target_viewport_type) {
-        target_viewport = to_viewport(target_viewport_arg);
-    } else {
-        target_viewport.width = target ? target->width : self->width;
-        target_viewport.height = target ? target->height : self->height;
+bool parse_timeout(PyObject * timeout_arg, unsigned long long * timeout) {
+    *timeout = GL_TIMEOUT_IGNORED;
+    if (timeout_arg != Py_None) {
+        double seconds = PyFloat_AsDouble(timeout_arg);
+        if (PyErr_Occurred()) {
+            return false;
+        }
+        *timeout = seconds > 0.0 ? (unsigned long long)(seconds * 1e9) : 0;
     }
+    return true;
+}
 
-    if (source_viewport_arg != Py_None && !invalid_source_viewport_type) {
-        source_viewport = to_viewport(source_viewport_arg);
-    } else {
-        source_viewport.width = self->width;
-        source_viewport.height = self->height;
+bool wait_async_read(AsyncRead * self, unsigned long long timeout) {
+    if (self->result) {
+        return true;
     }
+    return client_wait_sync(self->ctx, self->pixel_buffer.fence, timeout);
+}
 
-    const bool invalid_target_viewport = invalid_target_viewport_type || (
-        target_viewport.x < 0 || target_viewport.y < 0 || target_viewport.width <= 0 || target_viewport.height <= 0 ||
-        (target && (target_viewport.x + target_viewport.width > target->width || target_viewport.y + target_viewport.height > target->height))
-    );
+PyObject * AsyncRead_meth_ready(AsyncRead * self) {
+    wait_context(self->ctx);
+    return PyBool_FromLong(wait_async_read(self, 0));
+}
 
-    const bool invalid_source_viewport = invalid_source_viewport_type || (
-        source_viewport.x < 0 || source_viewport.y < 0 || source_viewport.width <= 0 || source_viewport.height <= 0 ||
-        source_viewport.x + source_viewport.width > self->width || source_viewport.y + source_viewport.height > self->height
-    );
+PyObject * AsyncRead_meth_wait(AsyncRead * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"timeout", NULL};
 
-    const bool invalid_target = invalid_target_type && (target->cubemap || target->array || !target->format.color);
-    const bool invalid_source = self->cubemap || self->array || !self->format.color;
+    wait_context(self->ctx);
 
-    const bool error = (
-        invalid_target_type || invalid_target_viewport_type || invalid_source_viewport_type ||
-        invalid_target_viewport || invalid_source_viewport || invalid_target || invalid_source
-    );
+    PyObject * timeout_arg = Py_None;
 
-    if (error) {
-        if (invalid_target_type) {
-            PyErr_Format(PyExc_TypeError, "target must be an Image or None");
-        } else if (invalid_target_viewport_type) {
-            PyErr_Format(PyExc_TypeError, "the target viewport must be a tuple of 4 ints");
-        } else if (invalid_source_viewport_type) {
-            PyErr_Format(PyExc_TypeError, "the source viewport must be a tuple of 4 ints");
-        } else if (invalid_target_viewport) {
-            PyErr_Format(PyExc_ValueError, "the target viewport is out of range");
-        } else if (invalid_source_viewport) {
-            PyErr_Format(PyExc_ValueError, "the source viewport is out of range");
-        } else if (self->cubemap) {
-            PyErr_Format(PyExc_TypeError, "cannot blit cubemap images");
-        } else if (self->array) {
-            PyErr_Format(PyExc_TypeError, "cannot blit array images");
-        } else if (!self->format.color) {
-            PyErr_Format(PyExc_TypeError, "cannot blit depth or stencil images");
-        } else if (target && target->cubemap) {
-            PyErr_Format(PyExc_TypeError, "cannot blit to cubemap images");
-        } else if (target && target->array) {
-            PyErr_Format(PyExc_TypeError, "cannot blit to array images");
-        } else if (!target && target->format.color) {
-            PyErr_Format(PyExc_TypeError, "cannot blit to depth or stencil images");
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "|O", keywords, &timeout_arg)) {
+        return NULL;
+    }
+
+    unsigned long long timeout = 0;
+    if (!parse_timeout(timeout_arg, &timeout)) {
+        return NULL;
+    }
+
+    return PyBool_FromLong(wait_async_read(self, timeout));
+}
+
+PyObject * AsyncRead_meth_result(AsyncRead * self) {
+    wait_context(self->ctx);
+
+    if (!self->result) {
+        const GLMethods & gl = self->ctx->gl;
+        if (!wait_async_read(self, GL_TIMEOUT_IGNORED)) {
+            PyErr_Format(PyExc_RuntimeError, "waiting for the read failed");
+            return NULL;
+        }
+        gl.BindBuffer(GL_PIXEL_PACK_BUFFER, self->pixel_buffer.buffer);
+        void * ptr = gl.MapBufferRange(GL_PIXEL_PACK_BUFFER, 0, self->size, GL_MAP_READ_BIT);
+        if (!ptr) {
+            gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            PyErr_Format(PyExc_RuntimeError, "cannot map the pixel buffer");
+            return NULL;
+        }
+        self->result = PyBytes_FromStringAndSize(NULL, self->size);
+        if (!self->result) {
+            gl.UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            return NULL;
         }
+        memcpy(PyBytes_AS_STRING(self->result), ptr, self->size);
+        self->ctx->stats.bytes_read += self->size;
+        gl.UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        gl.DeleteSync(self->pixel_buffer.fence);
+        self->pixel_buffer.fence = NULL;
+        give_pixel_buffer(self->ctx, self->pixel_buffer);
+        self->pixel_buffer.buffer = 0;
+    }
+
+    Py_INCREF(self->result);
+    return self->result;
+}
+
+Fence * Context_meth_fence(Context * self) {
+    wait_context(self);
+
+    Fence * res = PyObject_New(Fence, self->module_state->Fence_type);
+    res->ctx = (Context *)new_ref(self);
+    res->sync = self->gl.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    res->signaled = false;
+    res->released = false;
+    return res;
+}
+
+bool wait_fence(Fence * self, unsigned long long timeout) {
+    if (!self->signaled && client_wait_sync(self->ctx, self->sync, timeout)) {
+        self->ctx->gl.DeleteSync(self->sync);
+        self->sync = NULL;
+        self->signaled = true;
+    }
+    return self->signaled;
+}
+
+PyObject * Fence_meth_client_wait(Fence * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"timeout", NULL};
+
+    wait_context(self->ctx);
+
+    PyObject * timeout_arg = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "|O", keywords, &timeout_arg)) {
+        return NULL;
+    }
+
+    if (self->released) {
+        PyErr_Format(PyExc_RuntimeError, "the fence was released");
+        return NULL;
+    }
+
+    unsigned long long timeout = 0;
+    if (!parse_timeout(timeout_arg, &timeout)) {
+        return NULL;
+    }
+
+    return PyBool_FromLong(wait_fence(self, timeout));
+}
+
+PyObject * Fence_meth_wait(Fence * self) {
+    wait_context(self->ctx);
+
+    if (self->released) {
+        PyErr_Format(PyExc_RuntimeError, "the fence was released");
+        return NULL;
+    }
+
+    if (!self->signaled) {
+        self->ctx->gl.WaitSync(self->sync, 0, GL_TIMEOUT_IGNORED);
+    }
+    Py_RETURN_NONE;
+}
+
+PyObject * Fence_get_signaled(Fence * self) {
+    wait_context(self->ctx);
+
+    if (self->released) {
+        PyErr_Format(PyExc_RuntimeError, "the fence was released");
+        return NULL;
+    }
+
+    return PyBool_FromLong(wait_fence(self, 0));
+}
+
+int attach_read_image(Image * self, int layer, int level) {
+    Context * ctx = self->ctx;
+    const GLMethods & gl = ctx->gl;
+    if (self->framebuffer && !level) {
+        bind_framebuffer(ctx, self->framebuffer->obj);
+        return 0;
+    }
+
+    if (!ctx->read_framebuffer) {
+        gl.GenFramebuffers(1, (unsigned *)&ctx->read_framebuffer);
+    }
+
+    const int buffer = self->format.buffer;
+    const int attachment = buffer == GL_COLOR ? GL_COLOR_ATTACHMENT0 : buffer == GL_DEPTH ? GL_DEPTH_ATTACHMENT : buffer == GL_STENCIL ? GL_STENCIL_ATTACHMENT : GL_DEPTH_STENCIL_ATTACHMENT;
+    bind_framebuffer(ctx, ctx->read_framebuffer);
+    if (self->cubemap) {
+        gl.FramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer, self->image, level);
+    } else if (self->array) {
+        gl.FramebufferTextureLayer(GL_FRAMEBUFFER, attachment, self->image, level, layer);
+    } else {
+        gl.FramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, self->image, level);
+    }
+    gl.ReadBuffer(buffer == GL_COLOR ? GL_COLOR_ATTACHMENT0 : 0);
+    return attachment;
+}
+
+void detach_read_image(Image * self, int attachment) {
+    if (attachment) {
+        self->ctx->gl.FramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, 0, 0);
+    }
+}
+
+bool parse_read_region(Image * self, PyObject * size_arg, PyObject * offset_arg, PyObject * layer_arg, int level, ImageRegion * region) {
+    IntPair size = {};
+    IntPair offset = {};
+    int layer = 0;
+
+    const int width = level >= 0 && level < 32 && self->width >> level ? self->width >> level : 1;
+    const int height = level >= 0 && level < 32 && self->height >> level ? self->height >> level : 1;
+
+    const bool invalid_size_type = size_arg != Py_None && !is_int_pair(size_arg);
+    const bool invalid_offset_type = offset_arg != Py_None && !is_int_pair(offset_arg);
+    const bool invalid_layer_type = layer_arg != Py_None && !PyLong_CheckExact(layer_arg);
+
+    if (size_arg != Py_None && !invalid_size_type) {
+        size = to_int_pair(size_arg);
+    } else {
+        size.x = width;
+        size.y = height;
+    }
+
+    if (offset_arg != Py_None && !invalid_offset_type) {
+        offset = to_int_pair(offset_arg);
+    }
+
+    if (layer_arg != Py_None && !invalid_layer_type) {
+        layer = PyLong_AsLong(layer_arg);
+    }
+
+    const bool offset_but_no_size = size_arg == Py_None && offset_arg != Py_None;
+    const bool invalid_level = level < 0 || level >= 32 || (level && self->renderbuffer) || (!(self->width >> level) && !(self->height >> level));
+    const bool invalid_size = invalid_size_type || size.x <= 0 || size.y <= 0 || size.x > width || size.y > height;
+    const bool invalid_offset = invalid_offset_type || offset.x < 0 || offset.y < 0 || size.x + offset.x > width || size.y + offset.y > height;
+    const bool invalid_layer = invalid_layer_type || layer < 0 || (self->cubemap && layer >= 6) || (self->array && layer >= self->array);
+    const bool layer_but_simple = !self->cubemap && !self->array && layer;
+
+    if (offset_but_no_size || invalid_level || invalid_size || invalid_offset || invalid_layer || layer_but_simple || self->samples != 1) {
+        if (offset_but_no_size) {
+            PyErr_Format(PyExc_ValueError, "the size is required when the offset is not None");
+        } else if (invalid_size_type) {
+            PyErr_Format(PyExc_TypeError, "the size must be a tuple of 2 ints");
+        } else if (invalid_offset_type) {
+            PyErr_Format(PyExc_TypeError, "the offset must be a tuple of 2 ints");
+        } else if (invalid_layer_type) {
+            PyErr_Format(PyExc_TypeError, "the layer must be an int or None");
+        } else if (invalid_level) {
+            PyErr_Format(PyExc_ValueError, "invalid level");
+        } else if (invalid_size) {
+            PyErr_Format(PyExc_ValueError, "invalid size");
+        } else if (invalid_offset) {
+            PyErr_Format(PyExc_ValueError, "invalid offset");
+        } else if (invalid_layer) {
+            PyErr_Format(PyExc_ValueError, "invalid layer");
+        } else if (layer_but_simple) {
+            PyErr_Format(PyExc_TypeError, "the image is not layered");
+        } else if (self->samples != 1) {
+            PyErr_Format(PyExc_TypeError, "multisampled images must be blit to a non multisampled image before read");
+        }
+        return false;
+    }
+
+    region->size = size;
+    region->offset = offset;
+    region->layer = layer;
+    region->level = level;
+    return true;
+}
+
+void read_image(Image * self, const ImageRegion & region, void * data) {
+    const GLMethods & gl = self->ctx->gl;
+    const int attachment = attach_read_image(self, region.layer, region.level);
+    gl.ReadPixels(region.offset.x, region.offset.y, region.size.x, region.size.y, self->format.format, self->format.type, data);
+    detach_read_image(self, attachment);
+}
+
+PyObject * Image_meth_read_into(Image * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"dest", "size", "offset", "layer", "level", "stride", NULL};
+
+    wait_context(self->ctx);
+
+    Py_buffer view;
+    PyObject * size_arg = Py_None;
+    PyObject * offset_arg = Py_None;
+    PyObject * layer_arg = Py_None;
+    int level = 0;
+    PyObject * stride_arg = Py_None;
+
+    int args_ok = PyArg_ParseTupleAndKeywords(
+        vargs,
+        kwargs,
+        "w*|O$OOiO",
+        keywords,
+        &view,
+        &size_arg,
+        &offset_arg,
+        &layer_arg,
+        &level,
+        &stride_arg
+    );
+
+    if (!args_ok) {
+        return NULL;
+    }
+
+    ImageRegion region = {};
+    if (!parse_read_region(self, size_arg, offset_arg, layer_arg, level, &region)) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    const int row_size = region.size.x * self->format.pixel_size;
+    const bool invalid_stride_type = stride_arg != Py_None && !PyLong_CheckExact(stride_arg);
+    const int stride = stride_arg != Py_None && !invalid_stride_type ? PyLong_AsLong(stride_arg) : row_size;
+    const bool invalid_stride = invalid_stride_type || stride < row_size || stride % self->format.pixel_size;
+    const bool invalid_dest = !invalid_stride && view.len < (long long)stride * (region.size.y - 1) + row_size;
+
+    if (invalid_stride || invalid_dest) {
+        PyBuffer_Release(&view);
+        if (invalid_stride_type) {
+            PyErr_Format(PyExc_TypeError, "the stride must be an int or None");
+        } else if (invalid_stride) {
+            PyErr_Format(PyExc_ValueError, "invalid stride");
+        } else if (invalid_dest) {
+            PyErr_Format(PyExc_ValueError, "the destination is too small");
+        }
+        return NULL;
+    }
+
+    const GLMethods & gl = self->ctx->gl;
+
+    if (stride != row_size) {
+        gl.PixelStorei(GL_PACK_ROW_LENGTH, stride / self->format.pixel_size);
+    }
+    PyThreadState * state = begin_allow_threads(self->ctx, (long long)stride * region.size.y);
+    read_image(self, region, view.buf);
+    end_allow_threads(self->ctx, state);
+    self->ctx->stats.bytes_read += (long long)row_size * region.size.y;
+    if (stride != row_size) {
+        gl.PixelStorei(GL_PACK_ROW_LENGTH, 0);
+    }
+
+    PyBuffer_Release(&view);
+    Py_RETURN_NONE;
+}
+
+bool check_transfer_buffer(Image * self, Buffer * buffer, int buffer_offset, const ImageRegion & region) {
+    const int size = region.size.x * region.size.y * self->format.pixel_size;
+    const bool invalid_context = buffer->ctx != self->ctx;
+    const bool invalid_offset = buffer_offset < 0 || buffer_offset > buffer->size;
+    const bool invalid_size = !invalid_offset && size > buffer->size - buffer_offset;
+
+    if (invalid_context || buffer->mapped || invalid_offset || invalid_size) {
+        if (invalid_context) {
+            PyErr_Format(PyExc_ValueError, "the buffer belongs to a different context");
+        } else if (buffer->mapped) {
+            PyErr_Format(PyExc_RuntimeError, "the buffer is mapped");
+        } else if (invalid_offset) {
+            PyErr_Format(PyExc_ValueError, "invalid buffer_offset");
+        } else if (invalid_size) {
+            PyErr_Format(PyExc_ValueError, "the buffer is too small");
+        }
+        return false;
+    }
+
+    return true;
+}
+
+PyObject * Image_meth_write_from_buffer(Image * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"buffer", "buffer_offset", "size", "offset", "layer", NULL};
+
+    wait_context(self->ctx);
+
+    Buffer * buffer;
+    int buffer_offset = 0;
+    PyObject * size_arg = Py_None;
+    PyObject * offset_arg = Py_None;
+    PyObject * layer_arg = Py_None;
+
+    int args_ok = PyArg_ParseTupleAndKeywords(
+        vargs,
+        kwargs,
+        "O!|iO$OO",
+        keywords,
+        self->ctx->module_state->Buffer_type,
+        &buffer,
+        &buffer_offset,
+        &size_arg,
+        &offset_arg,
+        &layer_arg
+    );
+
+    if (!args_ok) {
+        return NULL;
+    }
+
+    ImageRegion region = {};
+    if (!parse_region(self, size_arg, offset_arg, layer_arg, &region)) {
+        return NULL;
+    }
+
+    if (!check_transfer_buffer(self, buffer, buffer_offset, region)) {
+        return NULL;
+    }
+
+    const GLMethods & gl = self->ctx->gl;
+
+    bind_default_texture(self->ctx, self->target, self->image);
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->buffer);
+    upload_image(self, region, (void *)(long long)(buffer->frame_offset + buffer_offset));
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    Py_RETURN_NONE;
+}
+
+PyObject * Image_meth_read_to_buffer(Image * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"buffer", "buffer_offset", "size", "offset", "layer", "level", NULL};
+
+    wait_context(self->ctx);
+
+    Buffer * buffer;
+    int buffer_offset = 0;
+    PyObject * size_arg = Py_None;
+    PyObject * offset_arg = Py_None;
+    PyObject * layer_arg = Py_None;
+    int level = 0;
+
+    int args_ok = PyArg_ParseTupleAndKeywords(
+        vargs,
+        kwargs,
+        "O!|iO$OOi",
+        keywords,
+        self->ctx->module_state->Buffer_type,
+        &buffer,
+        &buffer_offset,
+        &size_arg,
+        &offset_arg,
+        &layer_arg,
+        &level
+    );
+
+    if (!args_ok) {
+        return NULL;
+    }
+
+    ImageRegion region = {};
+    if (!parse_read_region(self, size_arg, offset_arg, layer_arg, level, &region)) {
+        return NULL;
+    }
+
+    if (!check_transfer_buffer(self, buffer, buffer_offset, region)) {
+        return NULL;
+    }
+
+    const GLMethods & gl = self->ctx->gl;
+
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, buffer->buffer);
+    read_image(self, region, (void *)(long long)(buffer->frame_offset + buffer_offset));
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    Py_RETURN_NONE;
+}
+
+bool parse_blit(Image * self, PyObject * vargs, PyObject * kwargs, BlitParams * params) {
+    static char * keywords[] = {"target", "target_viewport", "source_viewport", "filter", "srgb", NULL};
+
+    PyObject * target_arg = Py_None;
+    PyObject * target_viewport_arg = Py_None;
+    PyObject * source_viewport_arg = Py_None;
+    int filter = true;
+    int srgb = false;
+
+    int args_ok = PyArg_ParseTupleAndKeywords(
+        vargs,
+        kwargs,
+        "|OO$Opp",
+        keywords,
+        &target_arg,
+        &target_viewport_arg,
+        &source_viewport_arg,
+        &filter,
+        &srgb
+    );
+
+    if (!args_ok) {
+        return false;
+    }
+
+    const bool invalid_target_type = target_arg != Py_None && Py_TYPE(target_arg) != self->ctx->module_state->Image_type;
+
+    Image * target = target_arg != Py_None && !invalid_target_type ? (Image *)target_arg : NULL;
+
+    Viewport target_viewport = {};
+    Viewport source_viewport = {};
+
+    const bool invalid_target_viewport_type = target_viewport_arg != Py_None && !is_viewport(target_viewport_arg);
+    const bool invalid_source_viewport_type = source_viewport_arg != Py_None && !is_viewport(source_viewport_arg);
+
+    if (target_viewport_arg != Py_None && !invalid_target_viewport_type) {
+        target_viewport = to_viewport(target_viewport_arg);
+    } else {
+        target_viewport.width = target ? target->width : self->width;
+        target_viewport.height = target ? target->height : self->height;
+    }
+
+    if (source_viewport_arg != Py_None && !invalid_source_viewport_type) {
+        source_viewport = to_viewport(source_viewport_arg);
+    } else {
+        source_viewport.width = self->width;
+        source_viewport.height = self->height;
+    }
+
+    const bool invalid_target_viewport = invalid_target_viewport_type || (
+        target_viewport.x < 0 || target_viewport.y < 0 || target_viewport.width <= 0 || target_viewport.height <= 0 ||
+        (target && (target_viewport.x + target_viewport.width > target->width || target_viewport.y + target_viewport.height > target->height))
+    );
+
+    const bool invalid_source_viewport = invalid_source_viewport_type || (
+        source_viewport.x < 0 || source_viewport.y < 0 || source_viewport.width <= 0 || source_viewport.height <= 0 ||
+        source_viewport.x + source_viewport.width > self->width || source_viewport.y + source_viewport.height > self->height
+    );
+
+    const bool invalid_target = target && (target->cubemap || target->array || !target->format.color);
+    const bool invalid_source = self->cubemap || self->array || !self->format.color;
+
+    const bool error = (
+        invalid_target_type || invalid_target_viewport_type || invalid_source_viewport_type ||
+        invalid_target_viewport || invalid_source_viewport || invalid_target || invalid_source
+    );
+
+    if (error) {
+        if (invalid_target_type) {
+            PyErr_Format(PyExc_TypeError, "target must be an Image or None");
+        } else if (invalid_target_viewport_type) {
+            PyErr_Format(PyExc_TypeError, "the target viewport must be a tuple of 4 ints");
+        } else if (invalid_source_viewport_type) {
+            PyErr_Format(PyExc_TypeError, "the source viewport must be a tuple of 4 ints");
+        } else if (invalid_target_viewport) {
+            PyErr_Format(PyExc_ValueError, "the target viewport is out of range");
+        } else if (invalid_source_viewport) {
+            PyErr_Format(PyExc_ValueError, "the source viewport is out of range");
+        } else if (self->cubemap) {
+            PyErr_Format(PyExc_TypeError, "cannot blit cubemap images");
+        } else if (self->array) {
+            PyErr_Format(PyExc_TypeError, "cannot blit array images");
+        } else if (!self->format.color) {
+            PyErr_Format(PyExc_TypeError, "cannot blit depth or stencil images");
+        } else if (target && target->cubemap) {
+            PyErr_Format(PyExc_TypeError, "cannot blit to cubemap images");
+        } else if (target && target->array) {
+            PyErr_Format(PyExc_TypeError, "cannot blit to array images");
+        } else if (target && !target->format.color) {
+            PyErr_Format(PyExc_TypeError, "cannot blit to depth or stencil images");
+        }
+        return false;
+    }
+
+    params->target = target;
+    params->target_viewport = target_viewport;
+    params->source_viewport = source_viewport;
+    params->filter = filter;
+    params->srgb = srgb;
+    return true;
+}
+
+void blit_image(Image * self, const BlitParams & params) {
+    const Image * target = params.target;
+    const Viewport & target_viewport = params.target_viewport;
+    const Viewport & source_viewport = params.source_viewport;
+
+    const GLMethods & gl = self->ctx->gl;
+
+    if (!params.srgb) {
+        gl.Disable(GL_FRAMEBUFFER_SRGB);
+    }
+    self->ctx->current_global_settings = NULL;
+    set_color_mask(self->ctx, 0, 0xf);
+    self->ctx->current_framebuffer = -1;
+    gl.BindFramebuffer(GL_READ_FRAMEBUFFER, self->framebuffer->obj);
+    gl.BindFramebuffer(GL_DRAW_FRAMEBUFFER, target ? target->framebuffer->obj : 0);
+    gl.BlitFramebuffer(
+        source_viewport.x, source_viewport.y, source_viewport.x + source_viewport.width, source_viewport.y + source_viewport.height,
+        target_viewport.x, target_viewport.y, target_viewport.x + target_viewport.width, target_viewport.y + target_viewport.height,
+        GL_COLOR_BUFFER_BIT, params.filter ? GL_LINEAR : GL_NEAREST
+    );
+    if (!params.srgb) {
+        gl.Enable(GL_FRAMEBUFFER_SRGB);
+    }
+}
+
+PyObject * Image_meth_blit(Image * self, PyObject * vargs, PyObject * kwargs) {
+    wait_context(self->ctx);
+
+    BlitParams params = {};
+    if (!parse_blit(self, vargs, kwargs, &params)) {
+        return NULL;
+    }
+    blit_image(self, params);
+    Py_RETURN_NONE;
+}
+
+void copy_image(Image * self, Image * target, const ImageRegion & source, const ImageRegion & dest) {
+    Context * ctx = self->ctx;
+    const GLMethods & gl = ctx->gl;
+    const IntPair & size = source.size;
+    const int attachment = attach_read_image(self, source.layer, source.level);
+
+    if (target->renderbuffer) {
+        const int buffer = self->format.buffer;
+        const int mask = buffer == GL_COLOR ? GL_COLOR_BUFFER_BIT : buffer == GL_DEPTH ? GL_DEPTH_BUFFER_BIT : buffer == GL_STENCIL ? GL_STENCIL_BUFFER_BIT : GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
+        ctx->current_global_settings = NULL;
+        set_color_mask(ctx, 0, 0xf);
+        set_depth_write(ctx, 1);
+        set_stencil_write_mask(ctx, 0xff);
+        gl.Disable(GL_FRAMEBUFFER_SRGB);
+        gl.BindFramebuffer(GL_DRAW_FRAMEBUFFER, target->framebuffer->obj);
+        gl.BlitFramebuffer(
+            source.offset.x, source.offset.y, source.offset.x + size.x, source.offset.y + size.y,
+            dest.offset.x, dest.offset.y, dest.offset.x + size.x, dest.offset.y + size.y,
+            mask, GL_NEAREST
+        );
+        gl.Enable(GL_FRAMEBUFFER_SRGB);
+        gl.BindFramebuffer(GL_DRAW_FRAMEBUFFER, ctx->current_framebuffer);
+    } else {
+        bind_default_texture(ctx, target->target, target->image);
+        if (target->cubemap) {
+            const int face = GL_TEXTURE_CUBE_MAP_POSITIVE_X + dest.layer;
+            gl.CopyTexSubImage2D(face, dest.level, dest.offset.x, dest.offset.y, source.offset.x, source.offset.y, size.x, size.y);
+        } else if (target->array) {
+            gl.CopyTexSubImage3D(target->target, dest.level, dest.offset.x, dest.offset.y, dest.layer, source.offset.x, source.offset.y, size.x, size.y);
+        } else {
+            gl.CopyTexSubImage2D(target->target, dest.level, dest.offset.x, dest.offset.y, source.offset.x, source.offset.y, size.x, size.y);
+        }
+    }
+
+    detach_read_image(self, attachment);
+}
+
+PyObject * Image_meth_copy(Image * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"target", "size", "offset", "target_offset", "layer", "target_layer", "level", "target_level", NULL};
+
+    wait_context(self->ctx);
+
+    Image * target;
+    PyObject * size_arg = Py_None;
+    PyObject * offset_arg = Py_None;
+    PyObject * target_offset_arg = Py_None;
+    PyObject * layer_arg = Py_None;
+    PyObject * target_layer_arg = Py_None;
+    int level = 0;
+    int target_level = 0;
+
+    int args_ok = PyArg_ParseTupleAndKeywords(
+        vargs,
+        kwargs,
+        "O!|O$OOOOii",
+        keywords,
+        self->ctx->module_state->Image_type,
+        &target,
+        &size_arg,
+        &offset_arg,
+        &target_offset_arg,
+        &layer_arg,
+        &target_layer_arg,
+        &level,
+        &target_level
+    );
+
+    if (!args_ok) {
+        return NULL;
+    }
+
+    ImageRegion source = {};
+    if (!parse_read_region(self, size_arg, offset_arg, layer_arg, level, &source)) {
+        return NULL;
+    }
+
+    IntPair target_offset = {};
+    int target_layer = 0;
+
+    const bool invalid_target_offset_type = target_offset_arg != Py_None && !is_int_pair(target_offset_arg);
+    const bool invalid_target_layer_type = target_layer_arg != Py_None && !PyLong_CheckExact(target_layer_arg);
+
+    if (target_offset_arg != Py_None && !invalid_target_offset_type) {
+        target_offset = to_int_pair(target_offset_arg);
+    }
+
+    if (target_layer_arg != Py_None && !invalid_target_layer_type) {
+        target_layer = PyLong_AsLong(target_layer_arg);
+    }
+
+    const bool valid_target_level = target_level >= 0 && target_level < 32 && ((target->width >> target_level) || (target->height >> target_level));
+    const int target_width = valid_target_level && target->width >> target_level ? target->width >> target_level : 1;
+    const int target_height = valid_target_level && target->height >> target_level ? target->height >> target_level : 1;
+
+    const bool invalid_context = target->ctx != self->ctx;
+    const bool invalid_format = target->format.internal_format != self->format.internal_format;
+    const bool invalid_target_level = !valid_target_level || (target_level && target->renderbuffer);
+    const bool invalid_target_offset = invalid_target_offset_type || target_offset.x < 0 || target_offset.y < 0 || source.size.x + target_offset.x > target_width || source.size.y + target_offset.y > target_height;
+    const bool invalid_target_layer = invalid_target_layer_type || target_layer < 0 || (target->cubemap && target_layer >= 6) || (target->array && target_layer >= target->array);
+    const bool target_layer_but_simple = !target->cubemap && !target->array && target_layer;
+    const bool same_subresource = target == self && target_layer == source.layer && target_level == source.level;
+
+    const bool error = (
+        invalid_context || invalid_format || invalid_target_offset_type || invalid_target_layer_type || invalid_target_level ||
+        invalid_target_offset || invalid_target_layer || target_layer_but_simple || target->samples != 1 || same_subresource
+    );
+
+    if (error) {
+        if (invalid_context) {
+            PyErr_Format(PyExc_ValueError, "the target belongs to a different context");
+        } else if (invalid_format) {
+            PyErr_Format(PyExc_TypeError, "the source and target formats must match");
+        } else if (invalid_target_offset_type) {
+            PyErr_Format(PyExc_TypeError, "the target offset must be a tuple of 2 ints");
+        } else if (invalid_target_layer_type) {
+            PyErr_Format(PyExc_TypeError, "the target layer must be an int or None");
+        } else if (invalid_target_level) {
+            PyErr_Format(PyExc_ValueError, "invalid target level");
+        } else if (invalid_target_offset) {
+            PyErr_Format(PyExc_ValueError, "invalid target offset");
+        } else if (invalid_target_layer) {
+            PyErr_Format(PyExc_ValueError, "invalid target layer");
+        } else if (target_layer_but_simple) {
+            PyErr_Format(PyExc_TypeError, "the target image is not layered");
+        } else if (target->samples != 1) {
+            PyErr_Format(PyExc_TypeError, "cannot copy to multisampled images");
+        } else if (same_subresource) {
+            PyErr_Format(PyExc_ValueError, "cannot copy within the same layer and level");
+        }
+        return NULL;
+    }
+
+    ImageRegion dest = {};
+    dest.size = source.size;
+    dest.offset = target_offset;
+    dest.layer = target_layer;
+    dest.level = target_level;
+    copy_image(self, target, source, dest);
+    Py_RETURN_NONE;
+}
+
+PyObject * Image_get_clear_value(Image * self) {
+    if (self->format.clear_type == 'x') {
+        return Py_BuildValue("fi", self->clear_value.clear_floats[0], self->clear_value.clear_ints[1]);
+    }
+    if (self->format.components == 1) {
+        if (self->format.clear_type == 'f') {
+            return PyFloat_FromDouble(self->clear_value.clear_floats[0]);
+        } else if (self->format.clear_type == 'i') {
+            return PyLong_FromLong(self->clear_value.clear_ints[0]);
+        } else if (self->format.clear_type == 'u') {
+            return PyLong_FromUnsignedLong(self->clear_value.clear_uints[0]);
+        }
+    }
+    PyObject * res = PyTuple_New(self->format.components);
+    for (int i = 0; i < self->format.components; ++i) {
+        if (self->format.clear_type == 'f') {
+            PyTuple_SetItem(res, i, PyFloat_FromDouble(self->clear_value.clear_floats[i]));
+        } else if (self->format.clear_type == 'i') {
+            PyTuple_SetItem(res, i, PyLong_FromLong(self->clear_value.clear_ints[i]));
+        } else if (self->format.clear_type == 'u') {
+            PyTuple_SetItem(res, i, PyLong_FromUnsignedLong(self->clear_value.clear_uints[i]));
+        }
+    }
+    return res;
+}
+
+int Image_set_clear_value(Image * self, PyObject * value) {
+    ClearValue clear_value = {};
+    if (self->format.components == 1) {
+        if (self->format.clear_type == 'f' ? !PyFloat_CheckExact(value) : !PyLong_CheckExact(value)) {
+            if (self->format.clear_type == 'f') {
+                PyErr_Format(PyExc_TypeError, "the clear value must be a float");
+            } else {
+                PyErr_Format(PyExc_TypeError, "the clear value must be an int");
+            }
+            return -1;
+        }
+        if (self->format.clear_type == 'f') {
+            clear_value.clear_floats[0] = (float)PyFloat_AsDouble(value);
+        } else if (self->format.clear_type == 'i') {
+            clear_value.clear_ints[0] = PyLong_AsLong(value);
+        } else if (self->format.clear_type == 'u') {
+            clear_value.clear_uints[0] = PyLong_AsUnsignedLong(value);
+        }
+        self->clear_value = clear_value;
+        return 0;
+    }
+    PyObject * values = PySequence_Fast(value, "");
+    if (!values) {
+        PyErr_Clear();
+        PyErr_Format(PyExc_TypeError, "the clear value must be a tuple");
+        return -1;
+    }
+
+    int size = (int)PySequence_Fast_GET_SIZE(values);
+    PyObject ** seq = PySequence_Fast_ITEMS(values);
+
+    if (size != self->format.components) {
+        Py_DECREF(values);
+        PyErr_Format(PyExc_ValueError, "invalid clear value size");
+        return -1;
+    }
+
+    if (self->format.clear_type == 'f') {
+        for (int i = 0; i < self->format.components; ++i) {
+            clear_value.clear_floats[i] = (float)PyFloat_AsDouble(seq[i]);
+        }
+    } else if (self->format.clear_type == 'i') {
+        for (int i = 0; i < self->format.components; ++i) {
+            clear_value.clear_ints[i] = PyLong_AsLong(seq[i]);
+        }
+    } else if (self->format.clear_type == 'u') {
+        for (int i = 0; i < self->format.components; ++i) {
+            clear_value.clear_uints[i] = PyLong_AsUnsignedLong(seq[i]);
+        }
+    } else if (self->format.clear_type == 'x') {
+        clear_value.clear_floats[0] = (float)PyFloat_AsDouble(seq[0]);
+        clear_value.clear_ints[1] = PyLong_AsLong(seq[1]);
+    }
+    if (PyErr_Occurred()) {
+        Py_DECREF(values);
+        return -1;
+    }
+    self->clear_value = clear_value;
+    Py_DECREF(values);
+    return 0;
+}
+
+void collect_profile(Pipeline * self) {
+    const GLMethods & gl = self->ctx->gl;
+    int done = 0;
+    while (done < self->profile_query_count) {
+        const int query = self->profile_queries[done];
+        int available = 0;
+        gl.GetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        unsigned long long elapsed = 0;
+        gl.GetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+        self->gpu_time += elapsed;
+        self->gpu_time_count += 1;
+        give_query(self->ctx, query);
+        done += 1;
+    }
+    if (done) {
+        self->profile_query_count -= done;
+        memmove(self->profile_queries, self->profile_queries + done, self->profile_query_count * sizeof(int));
+    }
+}
+
+void render_profiled(Pipeline * self) {
+    Context * ctx = self->ctx;
+    const GLMethods & gl = ctx->gl;
+
+    collect_profile(self);
+
+    if (ctx->active_queries & query_bit(GL_TIME_ELAPSED)) {
+        render_pipeline(self);
+        return;
+    }
+
+    if (self->profile_query_count == self->profile_query_capacity) {
+        int capacity = self->profile_query_capacity ? self->profile_query_capacity * 2 : 4;
+        int * queries = (int *)realloc(self->profile_queries, capacity * sizeof(int));
+        if (!queries) {
+            render_pipeline(self);
+            return;
+        }
+        self->profile_queries = queries;
+        self->profile_query_capacity = capacity;
+    }
+
+    end_dropped_query(ctx, GL_TIME_ELAPSED);
+    const int query = take_query(ctx);
+    gl.BeginQuery(GL_TIME_ELAPSED, query);
+    render_pipeline(self);
+    gl.EndQuery(GL_TIME_ELAPSED);
+    self->profile_queries[self->profile_query_count++] = query;
+}
+
+bool get_ranges_buffer(PyObject * obj, Py_buffer * view) {
+    if (PyObject_GetBuffer(obj, view, PyBUF_FORMAT)) {
+        return false;
+    }
+
+    const char * format = view->format ? view->format : "B";
+    if (*format == '<' || *format == '=' || *format == '@') {
+        format += 1;
+    }
+
+    const bool raw_bytes = view->itemsize == 1 && (!strcmp(format, "B") || !strcmp(format, "b") || !strcmp(format, "c"));
+    const bool int32 = view->itemsize == 4 && (!strcmp(format, "i") || !strcmp(format, "l"));
+
+    if (!raw_bytes && !int32) {
+        PyErr_Format(PyExc_TypeError, "the ranges must be int32 values or bytes, got format \"%s\"", view->format);
+        PyBuffer_Release(view);
+        return false;
+    }
+    return true;
+}
+
+bool is_occlusion_query(Query * query) {
+    return query->target == GL_SAMPLES_PASSED || query->target == GL_ANY_SAMPLES_PASSED;
+}
+
+PyObject * Pipeline_meth_render(Pipeline * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"profile", "condition", NULL};
+
+    wait_context(self->ctx);
+
+    int profile = false;
+    PyObject * condition_arg = Py_None;
+
+    if ((kwargs || PyTuple_GET_SIZE(vargs)) && !PyArg_ParseTupleAndKeywords(vargs, kwargs, "|$pO", keywords, &profile, &condition_arg)) {
+        return NULL;
+    }
+
+    const bool invalid_condition_type = condition_arg != Py_None && Py_TYPE(condition_arg) != self->ctx->module_state->Query_type;
+    Query * condition = condition_arg != Py_None && !invalid_condition_type ? (Query *)condition_arg : NULL;
+    const bool invalid_condition = condition && (!is_occlusion_query(condition) || condition->ctx != self->ctx);
+    const bool condition_not_ended = condition && !invalid_condition && (!condition->issued || condition->active);
+
+    if (self->ctx->mapped_buffers || invalid_condition_type || invalid_condition || condition_not_ended) {
+        if (self->ctx->mapped_buffers) {
+            PyErr_Format(PyExc_RuntimeError, "rendering with mapped buffers");
+        } else if (invalid_condition_type) {
+            PyErr_Format(PyExc_TypeError, "the condition must be a Query or None");
+        } else if (invalid_condition) {
+            PyErr_Format(PyExc_ValueError, "the condition must be a samples_passed or any_samples_passed query");
+        } else if (condition_not_ended) {
+            PyErr_Format(PyExc_RuntimeError, "the condition query was not ended");
+        }
+        return NULL;
+    }
+
+    if (condition) {
+        self->ctx->gl.BeginConditionalRender(condition->query, GL_QUERY_WAIT);
+    }
+    if (profile) {
+        render_profiled(self);
+    } else {
+        render_pipeline(self);
+    }
+    if (condition) {
+        self->ctx->gl.EndConditionalRender();
+    }
+    Py_RETURN_NONE;
+}
+
+PyObject * Pipeline_meth_render_occlusion(Pipeline * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"queries", "ranges", NULL};
+
+    wait_context(self->ctx);
+
+    PyObject * queries_arg;
+    PyObject * ranges_arg = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "O|$O", keywords, &queries_arg, &ranges_arg)) {
+        return NULL;
+    }
+
+    if (self->ctx->mapped_buffers) {
+        PyErr_Format(PyExc_RuntimeError, "rendering with mapped buffers");
+        return NULL;
+    }
+
+    PyObject * queries = PySequence_Fast(queries_arg, "queries must be a sequence of Query objects");
+    if (!queries) {
+        return NULL;
+    }
+
+    const int count = (int)PySequence_Fast_GET_SIZE(queries);
+    PyObject ** items = PySequence_Fast_ITEMS(queries);
+
+    for (int i = 0; i < count; ++i) {
+        Query * query = (Query *)items[i];
+        const bool invalid_type = Py_TYPE(items[i]) != self->ctx->module_state->Query_type;
+        const bool invalid_kind = !invalid_type && (!is_occlusion_query(query) || query->ctx != self->ctx);
+        const bool released = !invalid_type && !invalid_kind && !query->query;
+        const bool busy = !invalid_type && !invalid_kind && (query->active || self->ctx->active_queries & query_bit(query->target));
+        if (invalid_type || invalid_kind || released || busy) {
+            Py_DECREF(queries);
+            if (invalid_type) {
+                PyErr_Format(PyExc_TypeError, "queries must be a sequence of Query objects");
+            } else if (invalid_kind) {
+                PyErr_Format(PyExc_ValueError, "the queries must be samples_passed or any_samples_passed queries");
+            } else if (released) {
+                PyErr_Format(PyExc_RuntimeError, "the query was released");
+            } else if (busy) {
+                PyErr_Format(PyExc_RuntimeError, "another query of the same kind is active");
+            }
+            return NULL;
+        }
+    }
+
+    Py_buffer view = {};
+    if (ranges_arg != Py_None) {
+        if (!get_ranges_buffer(ranges_arg, &view)) {
+            Py_DECREF(queries);
+            return NULL;
+        }
+        if (view.len != (Py_ssize_t)count * 8) {
+            PyBuffer_Release(&view);
+            Py_DECREF(queries);
+            PyErr_Format(PyExc_ValueError, "ranges must contain one (first_vertex, vertex_count) int32 pair per query");
+            return NULL;
+        }
+    }
+
+    Context * ctx = self->ctx;
+    const GLMethods & gl = ctx->gl;
+    const int * ranges = (const int *)view.buf;
+
+    bind_pipeline(self);
+    ctx->current_global_settings = NULL;
+    for (int i = 0; i < self->global_settings->attachments; ++i) {
+        set_color_mask(ctx, i, 0);
+    }
+    set_depth_write(ctx, 0);
+
+    long long vertices = 0;
+    for (int i = 0; i < count; ++i) {
+        Query * query = (Query *)items[i];
+        const int first_vertex = ranges ? ranges[i * 2] : self->first_vertex + i * self->vertex_count;
+        const int vertex_count = ranges ? ranges[i * 2 + 1] : self->vertex_count;
+        end_dropped_query(ctx, query->target);
+        gl.BeginQuery(query->target, query->query);
+        if (self->index_type) {
+            long long offset = (long long)first_vertex * self->index_size;
+            gl.DrawElementsInstancedBaseVertex(self->topology, vertex_count, self->index_type, (void *)offset, self->instance_count, self->base_vertex);
+        } else {
+            gl.DrawArraysInstanced(self->topology, first_vertex + self->base_vertex, vertex_count, self->instance_count);
+        }
+        gl.EndQuery(query->target);
+        query->issued = true;
+        vertices += (long long)vertex_count * self->instance_count;
+    }
+    count_draws(ctx, count, vertices, (long long)count * self->instance_count);
+    ctx->stats.gl_calls += count * 2;
+
+    if (ranges_arg != Py_None) {
+        PyBuffer_Release(&view);
+    }
+    Py_DECREF(queries);
+    Py_RETURN_NONE;
+}
+
+PyObject * Pipeline_get_gpu_time(Pipeline * self) {
+    wait_context(self->ctx);
+    collect_profile(self);
+    return PyLong_FromLongLong(self->gpu_time);
+}
+
+PyObject * Pipeline_get_gpu_time_count(Pipeline * self) {
+    wait_context(self->ctx);
+    collect_profile(self);
+    return PyLong_FromLong(self->gpu_time_count);
+}
+
+Query * Context_meth_query(Context * self, PyObject * arg) {
+    wait_context(self);
+
+    int target = 0;
+    if (PyUnicode_CheckExact(arg)) {
+        if (!PyUnicode_CompareWithASCIIString(arg, "time_elapsed")) {
+            target = GL_TIME_ELAPSED;
+        } else if (!PyUnicode_CompareWithASCIIString(arg, "timestamp")) {
+            target = GL_TIMESTAMP;
+        } else if (!PyUnicode_CompareWithASCIIString(arg, "primitives_generated")) {
+            target = GL_PRIMITIVES_GENERATED;
+        } else if (!PyUnicode_CompareWithASCIIString(arg, "samples_passed")) {
+            target = GL_SAMPLES_PASSED;
+        } else if (!PyUnicode_CompareWithASCIIString(arg, "any_samples_passed")) {
+            target = GL_ANY_SAMPLES_PASSED;
+        }
+    }
+
+    if (!target) {
+        PyErr_Format(PyExc_ValueError, "invalid query kind");
+        return NULL;
+    }
+
+    Query * res = PyObject_New(Query, self->module_state->Query_type);
+    res->ctx = (Context *)new_ref(self);
+    res->kind = (PyObject *)new_ref(arg);
+    res->query = take_query(self);
+    res->target = target;
+    res->active = false;
+    res->issued = false;
+    return res;
+}
+
+PyObject * Query_meth_begin(Query * self) {
+    wait_context(self->ctx);
+
+    const bool released = !self->query;
+    const bool timestamp = self->target == GL_TIMESTAMP;
+    const bool target_busy = !self->active && (self->ctx->active_queries & query_bit(self->target));
+
+    if (released || timestamp || self->active || target_busy) {
+        if (released) {
+            PyErr_Format(PyExc_RuntimeError, "the query was released");
+        } else if (timestamp) {
+            PyErr_Format(PyExc_TypeError, "timestamp queries are recorded with end only");
+        } else if (self->active) {
+            PyErr_Format(PyExc_RuntimeError, "the query is already active");
+        } else if (target_busy) {
+            PyErr_Format(PyExc_RuntimeError, "another query of the same kind is active");
+        }
+        return NULL;
+    }
+
+    end_dropped_query(self->ctx, self->target);
+    self->ctx->gl.BeginQuery(self->target, self->query);
+    self->ctx->active_queries |= query_bit(self->target);
+    self->active = true;
+    Py_RETURN_NONE;
+}
+
+PyObject * Query_meth_end(Query * self) {
+    wait_context(self->ctx);
+
+    const GLMethods & gl = self->ctx->gl;
+
+    if (!self->query) {
+        PyErr_Format(PyExc_RuntimeError, "the query was released");
+        return NULL;
+    } else if (self->target == GL_TIMESTAMP) {
+        gl.QueryCounter(self->query, GL_TIMESTAMP);
+    } else if (self->active) {
+        gl.EndQuery(self->target);
+        self->ctx->active_queries &= ~query_bit(self->target);
+        self->active = false;
+    } else {
+        PyErr_Format(PyExc_RuntimeError, "the query is not active");
+        return NULL;
+    }
+
+    self->issued = true;
+    Py_RETURN_NONE;
+}
+
+PyObject * Query_meth_result(Query * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"wait", NULL};
+
+    wait_context(self->ctx);
+
+    int wait = true;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "|p", keywords, &wait)) {
+        return NULL;
+    }
+
+    if (!self->query) {
+        PyErr_Format(PyExc_RuntimeError, "the query was released");
+        return NULL;
+    }
+
+    if (!self->issued || self->active) {
+        PyErr_Format(PyExc_RuntimeError, "the query was not ended");
+        return NULL;
+    }
+
+    const GLMethods & gl = self->ctx->gl;
+
+    if (!wait) {
+        int available = 0;
+        gl.GetQueryObjectiv(self->query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            Py_RETURN_NONE;
+        }
+    }
+
+    unsigned long long result = 0;
+    PyThreadState * state = wait ? release_context(self->ctx) : NULL;
+    gl.GetQueryObjectui64v(self->query, GL_QUERY_RESULT, &result);
+    end_allow_threads(self->ctx, state);
+    return PyLong_FromUnsignedLongLong(result);
+}
+
+void * get_scratch(Context * self, long long size) {
+    if (self->scratch_size < size) {
+        char * scratch = (char *)realloc(self->scratch, size);
+        if (!scratch) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+        self->scratch = scratch;
+        self->scratch_size = size;
+    }
+    return self->scratch;
+}
+
+PyObject * Pipeline_meth_render_ranges(Pipeline * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"ranges", "base_vertex", NULL};
+
+    wait_context(self->ctx);
+
+    PyObject * ranges_arg;
+    int base_vertex = false;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "O|$p", keywords, &ranges_arg, &base_vertex)) {
+        return NULL;
+    }
+
+    if (self->ctx->mapped_buffers) {
+        PyErr_Format(PyExc_RuntimeError, "rendering with mapped buffers");
+        return NULL;
+    }
+
+    Py_buffer view;
+    if (!get_ranges_buffer(ranges_arg, &view)) {
+        return NULL;
+    }
+
+    const int columns = base_vertex ? 4 : 3;
+
+    if (view.len % (columns * 4)) {
+        PyBuffer_Release(&view);
+        if (base_vertex) {
+            PyErr_Format(PyExc_ValueError, "ranges must contain (first_vertex, vertex_count, instance_count, base_vertex) int32 quadruplets");
+        } else {
+            PyErr_Format(PyExc_ValueError, "ranges must contain (first_vertex, vertex_count, instance_count) int32 triplets");
+        }
+        return NULL;
+    }
+
+    const int count = (int)(view.len / (columns * 4));
+    const int * ranges = (const int *)view.buf;
+
+    if (!count) {
+        PyBuffer_Release(&view);
+        Py_RETURN_NONE;
+    }
+
+    bool single_instance = true;
+    long long vertices = 0;
+    long long instances = 0;
+    for (int i = 0; i < count; ++i) {
+        if (ranges[i * columns + 2] != 1) {
+            single_instance = false;
+        }
+        vertices += (long long)ranges[i * columns + 1] * ranges[i * columns + 2];
+        instances += ranges[i * columns + 2];
+    }
+
+    const GLMethods & gl = self->ctx->gl;
+    bind_pipeline(self);
+    count_draws(self->ctx, single_instance ? 1 : count, vertices, instances);
+
+    if (single_instance && self->index_type) {
+        void * scratch = get_scratch(self->ctx, count * (sizeof(int) * 2 + sizeof(void *)));
+        if (!scratch) {
+            PyBuffer_Release(&view);
+            return NULL;
+        }
+        const void ** indices = (const void **)scratch;
+        int * vertex_count = (int *)(indices + count);
+        int * base_vertices = vertex_count + count;
+        for (int i = 0; i < count; ++i) {
+            indices[i] = (const void *)((long long)ranges[i * columns] * self->index_size);
+            vertex_count[i] = ranges[i * columns + 1];
+            base_vertices[i] = base_vertex ? ranges[i * columns + 3] : 0;
+        }
+        if (base_vertex) {
+            gl.MultiDrawElementsBaseVertex(self->topology, vertex_count, self->index_type, indices, count, base_vertices);
+        } else {
+            gl.MultiDrawElements(self->topology, vertex_count, self->index_type, indices, count);
+        }
+    } else if (single_instance) {
+        int * first_vertex = (int *)get_scratch(self->ctx, count * sizeof(int) * 2);
+        if (!first_vertex) {
+            PyBuffer_Release(&view);
+            return NULL;
+        }
+        int * vertex_count = first_vertex + count;
+        for (int i = 0; i < count; ++i) {
+            first_vertex[i] = ranges[i * columns] + (base_vertex ? ranges[i * columns + 3] : 0);
+            vertex_count[i] = ranges[i * columns + 1];
+        }
+        gl.MultiDrawArrays(self->topology, first_vertex, vertex_count, count);
+    } else if (self->index_type) {
+        for (int i = 0; i < count; ++i) {
+            const int * range = ranges + i * columns;
+            long long offset = (long long)range[0] * self->index_size;
+            if (base_vertex) {
+                gl.DrawElementsInstancedBaseVertex(self->topology, range[1], self->index_type, (void *)offset, range[2], range[3]);
+            } else {
+                gl.DrawElementsInstanced(self->topology, range[1], self->index_type, (void *)offset, range[2]);
+            }
+        }
+    } else {
+        for (int i = 0; i < count; ++i) {
+            const int * range = ranges + i * columns;
+            gl.DrawArraysInstanced(self->topology, range[0] + (base_vertex ? range[3] : 0), range[1], range[2]);
+        }
+    }
+
+    PyBuffer_Release(&view);
+    Py_RETURN_NONE;
+}
+
+PyObject * Pipeline_get_viewport(Pipeline * self) {
+    return Py_BuildValue("iiii", self->viewport.x, self->viewport.y, self->viewport.width, self->viewport.height);
+}
+
+int Pipeline_set_viewport(Pipeline * self, PyObject * viewport) {
+    if (!is_viewport(viewport)) {
+        PyErr_Format(PyExc_TypeError, "the viewport must be a tuple of 4 ints");
+        return -1;
+    }
+    self->viewport = to_viewport(viewport);
+    return 0;
+}
+
+BufferPool * Context_meth_buffer_pool(Context * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"size", "dynamic", NULL};
+
+    wait_context(self);
+
+    int size;
+    int dynamic = true;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "i|$p", keywords, &size, &dynamic)) {
+        return NULL;
+    }
+
+    if (size <= 0) {
+        PyErr_Format(PyExc_ValueError, "invalid size");
+        return NULL;
+    }
+
+    Buffer * buffer = create_buffer(self, size, NULL, dynamic);
+    if (!buffer) {
+        return NULL;
+    }
+
+    FreeBlock * blocks = (FreeBlock *)malloc(16 * sizeof(FreeBlock));
+    if (!blocks) {
+        release_buffer(self, buffer);
+        Py_DECREF(buffer);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    BufferPool * res = PyObject_New(BufferPool, self->module_state->BufferPool_type);
+    res->ctx = (Context *)new_ref(self);
+    res->buffer = buffer;
+    res->blocks = blocks;
+    res->blocks[0].offset = 0;
+    res->blocks[0].size = size;
+    res->block_count = 1;
+    res->block_capacity = 16;
+    res->used = 0;
+    return res;
+}
+
+bool insert_free_block(BufferPool * self, int index, int offset, int size) {
+    if (self->block_count == self->block_capacity) {
+        int capacity = self->block_capacity * 2;
+        FreeBlock * blocks = (FreeBlock *)realloc(self->blocks, capacity * sizeof(FreeBlock));
+        if (!blocks) {
+            PyErr_NoMemory();
+            return false;
+        }
+        self->blocks = blocks;
+        self->block_capacity = capacity;
+    }
+    memmove(self->blocks + index + 1, self->blocks + index, (self->block_count - index) * sizeof(FreeBlock));
+    self->blocks[index].offset = offset;
+    self->blocks[index].size = size;
+    self->block_count += 1;
+    return true;
+}
+
+void remove_free_block(BufferPool * self, int index) {
+    memmove(self->blocks + index, self->blocks + index + 1, (self->block_count - index - 1) * sizeof(FreeBlock));
+    self->block_count -= 1;
+}
+
+BufferSlice * BufferPool_meth_alloc(BufferPool * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"size", "alignment", NULL};
+
+    int size;
+    int alignment = 4;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "i|i", keywords, &size, &alignment)) {
+        return NULL;
+    }
+
+    const bool invalid_size = size <= 0;
+    const bool invalid_alignment = alignment <= 0 || (alignment & (alignment - 1));
+
+    if (invalid_size || invalid_alignment) {
+        if (invalid_size) {
+            PyErr_Format(PyExc_ValueError, "invalid size");
+        } else if (invalid_alignment) {
+            PyErr_Format(PyExc_ValueError, "the alignment must be a power of two");
+        }
+        return NULL;
+    }
+
+    for (int i = 0; i < self->block_count; ++i) {
+        const FreeBlock block = self->blocks[i];
+        const long long offset = ((long long)block.offset + alignment - 1) & ~((long long)alignment - 1);
+        if (offset + size > (long long)block.offset + block.size) {
+            continue;
+        }
+
+        const int head = (int)offset - block.offset;
+        const int tail = block.offset + block.size - (int)offset - size;
+        if (head && tail) {
+            self->blocks[i].size = head;
+            if (!insert_free_block(self, i + 1, (int)offset + size, tail)) {
+                self->blocks[i] = block;
+                return NULL;
+            }
+        } else if (head) {
+            self->blocks[i].size = head;
+        } else if (tail) {
+            self->blocks[i].offset = (int)offset + size;
+            self->blocks[i].size = tail;
+        } else {
+            remove_free_block(self, i);
+        }
+
+        BufferSlice * res = PyObject_New(BufferSlice, self->ctx->module_state->BufferSlice_type);
+        res->pool = (BufferPool *)new_ref(self);
+        res->buffer = (Buffer *)new_ref(self->buffer);
+        res->offset = (int)offset;
+        res->size = size;
+        res->allocated = true;
+        self->used += size;
+        return res;
+    }
+
+    PyErr_Format(PyExc_MemoryError, "the buffer pool cannot fit %d bytes", size);
+    return NULL;
+}
+
+PyObject * BufferPool_meth_free(BufferPool * self, PyObject * arg) {
+    if (Py_TYPE(arg) != self->ctx->module_state->BufferSlice_type || ((BufferSlice *)arg)->pool != self) {
+        PyErr_Format(PyExc_TypeError, "the argument must be a BufferSlice of this pool");
+        return NULL;
+    }
+
+    BufferSlice * slice = (BufferSlice *)arg;
+    if (!slice->allocated) {
+        PyErr_Format(PyExc_ValueError, "the slice is already free");
+        return NULL;
+    }
+
+    int index = 0;
+    while (index < self->block_count && self->blocks[index].offset < slice->offset) {
+        index += 1;
+    }
+
+    const bool merge_prev = index > 0 && self->blocks[index - 1].offset + self->blocks[index - 1].size == slice->offset;
+    const bool merge_next = index < self->block_count && slice->offset + slice->size == self->blocks[index].offset;
+
+    if (merge_prev && merge_next) {
+        self->blocks[index - 1].size += slice->size + self->blocks[index].size;
+        remove_free_block(self, index);
+    } else if (merge_prev) {
+        self->blocks[index - 1].size += slice->size;
+    } else if (merge_next) {
+        self->blocks[index].offset = slice->offset;
+        self->blocks[index].size += slice->size;
+    } else if (!insert_free_block(self, index, slice->offset, slice->size)) {
+        return NULL;
+    }
+
+    slice->allocated = false;
+    self->used -= slice->size;
+    Py_RETURN_NONE;
+}
+
+RingBuffer * Context_meth_ring_buffer(Context * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"size", "frames", NULL};
+
+    wait_context(self);
+
+    int size;
+    int frames = 3;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "i|$i", keywords, &size, &frames)) {
+        return NULL;
+    }
+
+    const int alignment = self->uniform_buffer_alignment;
+    const long long stride = ((long long)size + alignment - 1) / alignment * alignment;
+
+    const bool invalid_size = size <= 0;
+    const bool invalid_frames = frames < 1 || frames > 16;
+    const bool too_large = !invalid_size && !invalid_frames && stride * frames > 0x7fffffff;
+
+    if (invalid_size || invalid_frames || too_large) {
+        if (invalid_size) {
+            PyErr_Format(PyExc_ValueError, "invalid size");
+        } else if (invalid_frames) {
+            PyErr_Format(PyExc_ValueError, "invalid number of frames");
+        } else if (too_large) {
+            PyErr_Format(PyExc_ValueError, "the ring buffer is too large");
+        }
+        return NULL;
+    }
+
+    const GLMethods & gl = self->gl;
+    const int total = (int)(stride * frames);
+
+    if (!reserve_memory(self, "buffer", total)) {
+        return NULL;
+    }
+
+    int buffer = 0;
+    char * ptr = NULL;
+    gl.GenBuffers(1, (unsigned *)&buffer);
+    gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
+    if (self->buffer_storage) {
+        const int flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        gl.BufferStorage(GL_ARRAY_BUFFER, total, NULL, flags);
+        ptr = (char *)gl.MapBufferRange(GL_ARRAY_BUFFER, 0, total, flags);
+    } else {
+        gl.BufferData(GL_ARRAY_BUFFER, total, NULL, GL_STREAM_DRAW);
+    }
+
+    Buffer * res_buffer = PyObject_New(Buffer, self->module_state->Buffer_type);
+    res_buffer->ctx = (Context *)new_ref(self);
+    res_buffer->buffer = buffer;
+    res_buffer->size = size;
+    res_buffer->mapped = false;
+    res_buffer->ring = true;
+    res_buffer->frame_offset = 0;
+    res_buffer->memory = total;
+    self->memory.buffers += total;
+    Py_INCREF(res_buffer);
+
+    RingBuffer * res = PyObject_New(RingBuffer, self->module_state->RingBuffer_type);
+    res->ctx = (Context *)new_ref(self);
+    res->buffer = res_buffer;
+    res->fences = (void **)calloc(frames, sizeof(void *));
+    res->ptr = ptr;
+    res->size = size;
+    res->stride = (int)stride;
+    res->frames = frames;
+    res->frame = 0;
+    res->used = 0;
+    res->released = false;
+
+    PyList_Append(self->ring_buffers, (PyObject *)res);
+    return res;
+}
+
+void next_ring_frame(RingBuffer * self) {
+    const GLMethods & gl = self->ctx->gl;
+    self->fences[self->frame] = gl.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    self->frame = (self->frame + 1) % self->frames;
+    if (void * fence = self->fences[self->frame]) {
+        client_wait_sync(self->ctx, fence, GL_TIMEOUT_IGNORED);
+        gl.DeleteSync(fence);
+        self->fences[self->frame] = NULL;
+    }
+    self->buffer->frame_offset = self->frame * self->stride;
+    self->used = 0;
+}
+
+PyObject * RingBuffer_meth_write(RingBuffer * self, PyObject * arg) {
+    wait_context(self->ctx);
+
+    if (self->released) {
+        PyErr_Format(PyExc_RuntimeError, "the ring buffer was released");
+        return NULL;
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(arg, &view, PyBUF_SIMPLE)) {
+        return NULL;
+    }
+
+    const int alignment = self->ctx->uniform_buffer_alignment;
+    const int offset = (self->used + alignment - 1) / alignment * alignment;
+
+    if (offset > self->size || (int)view.len > self->size - offset) {
+        PyBuffer_Release(&view);
+        PyErr_Format(PyExc_ValueError, "the ring buffer has no room left in the current frame");
+        return NULL;
+    }
+
+    if (view.len) {
+        const int start = self->buffer->frame_offset + offset;
+        if (self->ptr) {
+            memcpy(self->ptr + start, view.buf, view.len);
+        } else {
+            const GLMethods & gl = self->ctx->gl;
+            const int access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+            gl.BindBuffer(GL_ARRAY_BUFFER, self->buffer->buffer);
+            void * ptr = gl.MapBufferRange(GL_ARRAY_BUFFER, start, view.len, access);
+            if (!ptr) {
+                PyBuffer_Release(&view);
+                PyErr_Format(PyExc_RuntimeError, "cannot map the ring buffer");
+                return NULL;
+            }
+            memcpy(ptr, view.buf, view.len);
+            gl.UnmapBuffer(GL_ARRAY_BUFFER);
+        }
+    }
+
+    self->used = offset + (int)view.len;
+    self->ctx->stats.bytes_uploaded += view.len;
+    PyBuffer_Release(&view);
+    return PyLong_FromLong(offset);
+}
+
+PyObject * RingBuffer_meth_next_frame(RingBuffer * self) {
+    wait_context(self->ctx);
+
+    if (self->released) {
+        PyErr_Format(PyExc_RuntimeError, "the ring buffer was released");
+        return NULL;
+    }
+
+    next_ring_frame(self);
+    Py_RETURN_NONE;
+}
+
+PyObject * Context_meth_end_frame(Context * self) {
+    wait_context(self);
+
+    for (int i = 0; i < PyList_GET_SIZE(self->ring_buffers); ++i) {
+        next_ring_frame((RingBuffer *)PyList_GET_ITEM(self->ring_buffers, i));
+    }
+
+    for (int i = 0; i < PyList_GET_SIZE(self->transient_frame); ++i) {
+        PyObject * item = PyList_GET_ITEM(self->transient_frame, i);
+        PyObject * pool = PyDict_GetItem(self->transient_images, PyTuple_GET_ITEM(item, 0));
+        PyList_Append(pool, PyTuple_GET_ITEM(item, 1));
+    }
+    PyList_SetSlice(self->transient_frame, 0, PyList_GET_SIZE(self->transient_frame), NULL);
+    Py_RETURN_NONE;
+}
+
+Image * Context_meth_transient_image(Context * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"size", "format", "samples", "texture", NULL};
+
+    int width;
+    int height;
+    PyObject * format_name;
+    int samples = 1;
+    PyObject * texture = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "(ii)O|$iO", keywords, &width, &height, &format_name, &samples, &texture)) {
+        return NULL;
+    }
+
+    const int renderbuffer = samples > 1 || texture == Py_False;
+    PyObject * key = Py_BuildValue("(iiOiO)", width, height, format_name, samples, renderbuffer ? Py_True : Py_False);
+    PyObject * pool = PyDict_GetItemWithError(self->transient_images, key);
+    if (!pool && PyErr_Occurred()) {
+        Py_DECREF(key);
+        return NULL;
+    }
+
+    Image * res = NULL;
+    if (pool && PyList_GET_SIZE(pool)) {
+        const Py_ssize_t last = PyList_GET_SIZE(pool) - 1;
+        res = (Image *)new_ref(PyList_GET_ITEM(pool, last));
+        PyList_SetSlice(pool, last, last + 1, NULL);
+        self->stats.transient_image_pool.hits += 1;
+    } else {
+        PyObject * image_args = Py_BuildValue("((ii)O)", width, height, format_name);
+        PyObject * image_kwargs = Py_BuildValue("{sisO}", "samples", samples, "texture", texture);
+        res = Context_meth_image(self, image_args, image_kwargs);
+        Py_DECREF(image_args);
+        Py_DECREF(image_kwargs);
+        if (!res) {
+            Py_DECREF(key);
+            return NULL;
+        }
+        res->transient = true;
+        if (!pool) {
+            pool = PyList_New(0);
+            PyDict_SetItem(self->transient_images, key, pool);
+            Py_DECREF(pool);
+        }
+        self->stats.transient_image_pool.misses += 1;
+    }
+
+    PyObject * item = Py_BuildValue("(NO)", key, res);
+    PyList_Append(self->transient_frame, item);
+    Py_DECREF(item);
+    return res;
+}
+
+bool release_transient_image(Context * self, PyObject * image) {
+    ((Image *)image)->transient = false;
+    PyObject * res = Context_meth_release(self, image);
+    Py_XDECREF(res);
+    return res != NULL;
+}
+
+PyObject * Context_meth_clear_transient_images(Context * self) {
+    PyObject * key = NULL;
+    PyObject * value = NULL;
+    Py_ssize_t pos = 0;
+    while (PyDict_Next(self->transient_framebuffers, &pos, &key, &value)) {
+        release_framebuffer(self, (GLObject *)value);
+    }
+    PyDict_Clear(self->transient_framebuffers);
+
+    pos = 0;
+    while (PyDict_Next(self->transient_images, &pos, &key, &value)) {
+        for (int i = 0; i < PyList_GET_SIZE(value); ++i) {
+            if (!release_transient_image(self, PyList_GET_ITEM(value, i))) {
+                return NULL;
+            }
+        }
+    }
+    PyDict_Clear(self->transient_images);
+
+    for (int i = 0; i < PyList_GET_SIZE(self->transient_frame); ++i) {
+        if (!release_transient_image(self, PyTuple_GET_ITEM(PyList_GET_ITEM(self->transient_frame, i), 1))) {
+            return NULL;
+        }
+    }
+    PyList_SetSlice(self->transient_frame, 0, PyList_GET_SIZE(self->transient_frame), NULL);
+    Py_RETURN_NONE;
+}
+
+PyObject * Context_meth_memory(Context * self) {
+    const ContextMemory & memory = self->memory;
+    return Py_BuildValue(
+        "{sLsLsLsLsL}",
+        "buffers", memory.buffers,
+        "images", memory.images,
+        "renderbuffers", memory.renderbuffers,
+        "staging", memory.staging,
+        "total", total_memory(self)
+    );
+}
+
+PyObject * Context_get_memory_budget(Context * self) {
+    if (self->memory_budget < 0) {
+        Py_RETURN_NONE;
+    }
+    return PyLong_FromLongLong(self->memory_budget);
+}
+
+int Context_set_memory_budget(Context * self, PyObject * value) {
+    if (!value || value == Py_None) {
+        self->memory_budget = -1;
+        return 0;
+    }
+
+    const bool invalid_type = !PyLong_CheckExact(value);
+    const long long budget = invalid_type ? 0 : PyLong_AsLongLong(value);
+    const bool invalid_budget = !invalid_type && budget < 0;
+
+    if (invalid_type || invalid_budget) {
+        if (invalid_type) {
+            PyErr_Format(PyExc_TypeError, "the memory budget must be an int or None");
+        } else if (invalid_budget) {
+            PyErr_Format(PyExc_ValueError, "invalid memory budget");
+        }
+        return -1;
+    }
+
+    self->memory_budget = budget;
+    return 0;
+}
+
+PyObject * build_cache_stats(PyObject * cache, const CacheStats & stats) {
+    return Py_BuildValue("{sisLsL}", "size", (int)PyDict_Size(cache), "hits", stats.hits, "misses", stats.misses);
+}
+
+PyObject * Context_meth_stats(Context * self) {
+    wait_context(self);
+
+    const ContextStats & stats = self->stats;
+
+    PyObject * state_changes = Py_BuildValue(
+        "{s(LL)s(LL)s(LL)s(LL)s(LL)}",
+        "framebuffer", stats.framebuffer_binds, stats.framebuffer_skips,
+        "program", stats.program_binds, stats.program_skips,
+        "vertex_array", stats.vertex_array_binds, stats.vertex_array_skips,
+        "global_settings", stats.global_settings_binds, stats.global_settings_skips,
+        "descriptor_set", stats.descriptor_set_binds, stats.descriptor_set_skips
+    );
+
+    PyObject * caches = Py_BuildValue(
+        "{sNsNsNsNsNsNsNsNsNs{sLsL}s{sLsL}}",
+        "descriptor_set_buffers", build_cache_stats(self->descriptor_set_buffers_cache, stats.descriptor_set_buffers_cache),
+        "descriptor_set_images", build_cache_stats(self->descriptor_set_images_cache, stats.descriptor_set_images_cache),
+        "global_settings", build_cache_stats(self->global_settings_cache, stats.global_settings_cache),
+        "sampler", build_cache_stats(self->sampler_cache, stats.sampler_cache),
+        "vertex_array", build_cache_stats(self->vertex_array_cache, stats.vertex_array_cache),
+        "framebuffer", build_cache_stats(self->framebuffer_cache, stats.framebuffer_cache),
+        "program", build_cache_stats(self->program_cache, stats.program_cache),
+        "shader", build_cache_stats(self->shader_cache, stats.shader_cache),
+        "source", build_cache_stats(self->source_cache, stats.source_cache),
+        "program_binary", "hits", stats.program_binary_cache.hits, "misses", stats.program_binary_cache.misses,
+        "transient_image", "hits", stats.transient_image_pool.hits, "misses", stats.transient_image_pool.misses
+    );
+
+    return Py_BuildValue(
+        "{sLsLsLsLsNsNsLsL}",
+        "gl_calls", stats.gl_calls,
+        "draw_calls", stats.draw_calls,
+        "vertices", stats.vertices,
+        "instances", stats.instances,
+        "state_changes", state_changes,
+        "caches", caches,
+        "bytes_uploaded", stats.bytes_uploaded,
+        "bytes_read", stats.bytes_read
+    );
+}
+
+PyObject * Context_meth_reset_stats(Context * self) {
+    wait_context(self);
+
+    memset(&self->stats, 0, sizeof(self->stats));
+    Py_RETURN_NONE;
+}
+
+CommandList * Context_meth_command_list(Context * self) {
+    CommandList * res = PyObject_New(CommandList, self->module_state->CommandList_type);
+    res->ctx = (Context *)new_ref(self);
+    res->objects = PyList_New(0);
+    res->commands = NULL;
+    res->views = NULL;
+    res->count = 0;
+    res->capacity = 0;
+    res->view_count = 0;
+    res->view_capacity = 0;
+    return res;
+}
+
+Command * add_command(CommandList * self, int type, PyObject * obj) {
+    if (self->count == self->capacity) {
+        int capacity = self->capacity ? self->capacity * 2 : 16;
+        Command * commands = (Command *)realloc(self->commands, capacity * sizeof(Command));
+        if (!commands) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+        self->commands = commands;
+        self->capacity = capacity;
+    }
+    if (PyList_Append(self->objects, obj)) {
+        return NULL;
+    }
+    Command * command = &self->commands[self->count++];
+    memset(command, 0, sizeof(Command));
+    command->type = type;
+    return command;
+}
+
+bool check_owner(CommandList * self, PyObject * obj, PyTypeObject * type, Context * ctx, const char * name) {
+    if (Py_TYPE(obj) != type) {
+        PyErr_Format(PyExc_TypeError, "%s must be a %s", name, type->tp_name);
+        return false;
+    }
+    if (ctx != self->ctx) {
+        PyErr_Format(PyExc_ValueError, "the %s belongs to a different context", name);
+        return false;
+    }
+    return true;
+}
+
+PyObject * CommandList_meth_render(CommandList * self, PyObject * arg) {
+    ModuleState * module_state = self->ctx->module_state;
+    if (!check_owner(self, arg, module_state->Pipeline_type, Py_TYPE(arg) == module_state->Pipeline_type ? ((Pipeline *)arg)->ctx : NULL, "pipeline")) {
+        return NULL;
+    }
+    Command * command = add_command(self, COMMAND_RENDER, arg);
+    if (!command) {
+        return NULL;
+    }
+    command->render.pipeline = (Pipeline *)arg;
+    Py_RETURN_NONE;
+}
+
+PyObject * CommandList_meth_viewport(CommandList * self, PyObject * vargs) {
+    PyObject * pipeline;
+    PyObject * viewport;
+
+    if (!PyArg_ParseTuple(vargs, "OO", &pipeline, &viewport)) {
+        return NULL;
+    }
+
+    ModuleState * module_state = self->ctx->module_state;
+    if (!check_owner(self, pipeline, module_state->Pipeline_type, Py_TYPE(pipeline) == module_state->Pipeline_type ? ((Pipeline *)pipeline)->ctx : NULL, "pipeline")) {
+        return NULL;
+    }
+
+    if (!is_viewport(viewport)) {
+        PyErr_Format(PyExc_TypeError, "the viewport must be a tuple of 4 ints");
         return NULL;
     }
 
-    const GLMethods & gl = self->ctx->gl;
+    Command * command = add_command(self, COMMAND_VIEWPORT, pipeline);
+    if (!command) {
+        return NULL;
+    }
+    command->viewport.pipeline = (Pipeline *)pipeline;
+    command->viewport.viewport = to_viewport(viewport);
+    Py_RETURN_NONE;
+}
 
-    if (!srgb) {
-        gl.Disable(GL_FRAMEBUFFER_SRGB);
+PyObject * CommandList_meth_clear(CommandList * self, PyObject * arg) {
+    ModuleState * module_state = self->ctx->module_state;
+    if (!check_owner(self, arg, module_state->Image_type, Py_TYPE(arg) == module_state->Image_type ? ((Image *)arg)->ctx : NULL, "image")) {
+        return NULL;
     }
-    gl.ColorMaski(0, 1, 1, 1, 1);
-    gl.BindFramebuffer(GL_READ_FRAMEBUFFER, self->framebuffer->obj);
-    gl.BindFramebuffer(GL_DRAW_FRAMEBUFFER, target ? target->framebuffer->obj : 0);
-    gl.BlitFramebuffer(
-        source_viewport.x, source_viewport.y, source_viewport.x + source_viewport.width, source_viewport.y + source_viewport.height,
-        target_viewport.x, target_viewport.y, target_viewport.x + target_viewport.width, target_viewport.y + target_viewport.height,
-        GL_COLOR_BUFFER_BIT, filter ? GL_LINEAR : GL_NEAREST
-    );
-    gl.BindFramebuffer(GL_FRAMEBUFFER, self->ctx->current_framebuffer);
-    if (GlobalSettings * settings = self->ctx->current_global_settings) {
-        gl.ColorMaski(0, settings->color_mask & 1, settings->color_mask & 2, settings->color_mask & 4, settings->color_mask & 8);
+    if (!check_clear((Image *)arg)) {
+        return NULL;
     }
-    if (!srgb) {
-        gl.Enable(GL_FRAMEBUFFER_SRGB);
+    Command * command = add_command(self, COMMAND_CLEAR, arg);
+    if (!command) {
+        return NULL;
     }
+    command->clear.image = (Image *)arg;
     Py_RETURN_NONE;
 }
 
-PyObject * Image_get_clear_value(Image * self) {
-    if (self->format.clear_type == 'x') {
-        return Py_BuildValue("fi", self->clear_value.clear_floats[0], self->clear_value.clear_ints[1]);
+PyObject * CommandList_meth_blit(CommandList * self, PyObject * vargs, PyObject * kwargs) {
+    ModuleState * module_state = self->ctx->module_state;
+    if (PyTuple_Size(vargs) < 1) {
+        PyErr_Format(PyExc_TypeError, "missing the image argument");
+        return NULL;
     }
-    if (self->format.components == 1) {
-        if (self->format.clear_type == 'f') {
-            return PyFloat_FromDouble(self->clear_value.clear_floats[0]);
-        } else if (self->format.clear_type == 'i') {
-            return PyLong_FromLong(self->clear_value.clear_ints[0]);
-        } else if (self->format.clear_type == 'u') {
-            return PyLong_FromUnsignedLong(self->clear_value.clear_uints[0]);
-        }
+
+    PyObject * image = PyTuple_GetItem(vargs, 0);
+    if (!check_owner(self, image, module_state->Image_type, Py_TYPE(image) == module_state->Image_type ? ((Image *)image)->ctx : NULL, "image")) {
+        return NULL;
     }
-    PyObject * res = PyTuple_New(self->format.components);
-    for (int i = 0; i < self->format.components; ++i) {
-        if (self->format.clear_type == 'f') {
-            PyTuple_SetItem(res, i, PyFloat_FromDouble(self->clear_value.clear_floats[i]));
-        } else if (self->format.clear_type == 'i') {
-            PyTuple_SetItem(res, i, PyLong_FromLong(self->clear_value.clear_ints[i]));
-        } else if (self->format.clear_type == 'u') {
-            PyTuple_SetItem(res, i, PyLong_FromUnsignedLong(self->clear_value.clear_uints[i]));
-        }
+
+    BlitParams params = {};
+    PyObject * args = PyTuple_GetSlice(vargs, 1, PyTuple_Size(vargs));
+    const bool args_ok = parse_blit((Image *)image, args, kwargs, &params);
+    Py_DECREF(args);
+    if (!args_ok) {
+        return NULL;
     }
-    return res;
-}
 
-int Image_set_clear_value(Image * self, PyObject * value) {
-    ClearValue clear_value = {};
-    if (self->format.components == 1) {
-        if (self->format.clear_type == 'f' ? !PyFloat_CheckExact(value) : !PyLong_CheckExact(value)) {
-            if (self->format.clear_type == 'f') {
-                PyErr_Format(PyExc_TypeError, "the clear value must be a float");
-            } else {
-                PyErr_Format(PyExc_TypeError, "the clear value must be an int");
-            }
-            return -1;
-        }
-        if (self->format.clear_type == 'f') {
-            clear_value.clear_floats[0] = (float)PyFloat_AsDouble(value);
-        } else if (self->format.clear_type == 'i') {
-            clear_value.clear_ints[0] = PyLong_AsLong(value);
-        } else if (self->format.clear_type == 'u') {
-            clear_value.clear_uints[0] = PyLong_AsUnsignedLong(value);
-        }
-        self->clear_value = clear_value;
-        return 0;
+    if (params.target && params.target->ctx != self->ctx) {
+        PyErr_Format(PyExc_ValueError, "the target belongs to a different context");
+        return NULL;
     }
-    PyObject * values = PySequence_Fast(value, "");
-    if (!values) {
-        PyErr_Clear();
-        PyErr_Format(PyExc_TypeError, "the clear value must be a tuple");
-        return -1;
+
+    Command * command = add_command(self, COMMAND_BLIT, image);
+    if (!command) {
+        return NULL;
+    }
+    if (params.target && PyList_Append(self->objects, (PyObject *)params.target)) {
+        self->count -= 1;
+        return NULL;
     }
+    command->blit.image = (Image *)image;
+    command->blit.params = params;
+    Py_RETURN_NONE;
+}
 
-    int size = (int)PySequence_Fast_GET_SIZE(values);
-    PyObject ** seq = PySequence_Fast_ITEMS(values);
+PyObject * CommandList_meth_write(CommandList * self, PyObject * vargs, PyObject * kwargs) {
+    static char * keywords[] = {"buffer", "data", "offset", NULL};
 
-    if (size != self->format.components) {
-        Py_DECREF(values);
-        PyErr_Format(PyExc_ValueError, "invalid clear value size");
-        return -1;
+    PyObject * buffer;
+    PyObject * data;
+    int offset = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(vargs, kwargs, "OO|i", keywords, &buffer, &data, &offset)) {
+        return NULL;
     }
 
-    if (self->format.clear_type == 'f') {
-        for (int i = 0; i < self->format.components; ++i) {
-            clear_value.clear_floats[i] = (float)PyFloat_AsDouble(seq[i]);
-        }
-    } else if (self->format.clear_type == 'i') {
-        for (int i = 0; i < self->format.components; ++i) {
-            clear_value.clear_ints[i] = PyLong_AsLong(seq[i]);
+    ModuleState * module_state = self->ctx->module_state;
+    if (!check_owner(self, buffer, module_state->Buffer_type, Py_TYPE(buffer) == module_state->Buffer_type ? ((Buffer *)buffer)->ctx : NULL, "buffer")) {
+        return NULL;
+    }
+
+    if (self->view_count == self->view_capacity) {
+        int capacity = self->view_capacity ? self->view_capacity * 2 : 16;
+        Py_buffer * views = (Py_buffer *)realloc(self->views, capacity * sizeof(Py_buffer));
+        if (!views) {
+            PyErr_NoMemory();
+            return NULL;
         }
-    } else if (self->format.clear_type == 'u') {
-        for (int i = 0; i < self->format.components; ++i) {
-            clear_value.clear_uints[i] = PyLong_AsUnsignedLong(seq[i]);
+        self->views = views;
+        self->view_capacity = capacity;
+    }
+
+    Py_buffer * view = &self->views[self->view_count];
+    if (PyObject_GetBuffer(data, view, PyBUF_SIMPLE)) {
+        return NULL;
+    }
+
+    const int size = ((Buffer *)buffer)->size;
+    const bool invalid_offset = offset < 0 || offset > size;
+    const bool invalid_size = (int)view->len > size - offset;
+
+    if (invalid_offset || invalid_size) {
+        PyBuffer_Release(view);
+        if (invalid_offset) {
+            PyErr_Format(PyExc_ValueError, "invalid offset");
+        } else if (invalid_size) {
+            PyErr_Format(PyExc_ValueError, "invalid size");
         }
-    } else if (self->format.clear_type == 'x') {
-        clear_value.clear_floats[0] = (float)PyFloat_AsDouble(seq[0]);
-        clear_value.clear_ints[1] = PyLong_AsLong(seq[1]);
+        return NULL;
     }
-    if (PyErr_Occurred()) {
-        Py_DECREF(values);
-        return -1;
+
+    Command * command = add_command(self, COMMAND_WRITE, buffer);
+    if (!command) {
+        PyBuffer_Release(view);
+        return NULL;
     }
-    self->clear_value = clear_value;
-    Py_DECREF(values);
-    return 0;
+    self->view_count += 1;
+    command->write.buffer = (Buffer *)buffer;
+    command->write.offset = offset;
+    command->write.size = (int)view->len;
+    command->write.data = view->buf;
+    Py_RETURN_NONE;
 }
 
-PyObject * Pipeline_meth_render(Pipeline * self) {
-    if (self->ctx->mapped_buffers) {
-        PyErr_Format(PyExc_RuntimeError, "rendering with mapped buffers");
+PyObject * Context_meth_execute(Context * self, PyObject * arg) {
+    wait_context(self);
+
+    if (Py_TYPE(arg) != self->module_state->CommandList_type || ((CommandList *)arg)->ctx != self) {
+        PyErr_Format(PyExc_TypeError, "the argument must be a CommandList of this context");
         return NULL;
     }
-    const GLMethods & gl = self->ctx->gl;
-    if (self->viewport.viewport != self->ctx->viewport.viewport) {
-        gl.Viewport(self->viewport.x, self->viewport.y, self->viewport.width, self->viewport.height);
+
+    if (self->mapped_buffers) {
+        PyErr_Format(PyExc_RuntimeError, "rendering with mapped buffers");
+        return NULL;
     }
-    bind_global_settings(self->ctx, self->global_settings);
-    bind_framebuffer(self->ctx, self->framebuffer->obj);
-    bind_program(self->ctx, self->program->obj);
-    bind_vertex_array(self->ctx, self->vertex_array->obj);
-    bind_descriptor_set_buffers(self->ctx, self->descriptor_set_buffers);
-    bind_descriptor_set_images(self->ctx, self->descriptor_set_images);
-    if (self->index_type) {
-        long long offset = self->first_vertex * self->index_size;
-        gl.DrawElementsInstanced(self->topology, self->vertex_count, self->index_type, (void *)offset, self->instance_count);
-    } else {
-        gl.DrawArraysInstanced(self->topology, self->first_vertex, self->vertex_count, self->instance_count);
+
+    CommandList * command_list = (CommandList *)arg;
+    for (int i = 0; i < command_list->count; ++i) {
+        const Command & command = command_list->commands[i];
+        const bool render_released = command.type == COMMAND_RENDER && command.render.pipeline->released;
+        const bool viewport_released = command.type == COMMAND_VIEWPORT && command.viewport.pipeline->released;
+        if (render_released || viewport_released) {
+            PyErr_Format(PyExc_RuntimeError, "the command list uses a released pipeline");
+            return NULL;
+        }
     }
-    Py_RETURN_NONE;
-}
 
-PyObject * Pipeline_get_viewport(Pipeline * self) {
-    return Py_BuildValue("iiii", self->viewport.x, self->viewport.y, self->viewport.width, self->viewport.height);
-}
+    for (int i = 0; i < command_list->count; ++i) {
+        Command & command = command_list->commands[i];
+        switch (command.type) {
+            case COMMAND_RENDER:
+                render_pipeline(command.render.pipeline);
+                break;
+            case COMMAND_VIEWPORT:
+                command.viewport.previous = command.viewport.pipeline->viewport;
+                command.viewport.pipeline->viewport = command.viewport.viewport;
+                break;
+            case COMMAND_CLEAR:
+                clear_image(command.clear.image);
+                break;
+            case COMMAND_BLIT:
+                blit_image(command.blit.image, command.blit.params);
+                break;
+            case COMMAND_WRITE:
+                write_buffer(command.write.buffer, command.write.offset, command.write.size, command.write.data);
+                break;
+        }
+    }
 
-int Pipeline_set_viewport(Pipeline * self, PyObject * viewport) {
-    if (!is_viewport(viewport)) {
-        PyErr_Format(PyExc_TypeError, "the viewport must be a tuple of 4 ints");
-        return -1;
+    for (int i = command_list->count - 1; i >= 0; --i) {
+        const Command & command = command_list->commands[i];
+        if (command.type == COMMAND_VIEWPORT) {
+            command.viewport.pipeline->viewport = command.viewport.previous;
+        }
     }
-    self->viewport = to_viewport(viewport);
-    return 0;
+
+    Py_RETURN_NONE;
 }
 
 struct vec3 {
@@ -1961,8 +6433,19 @@ void Context_dealloc(Context * self) {
     Py_DECREF(self->framebuffer_cache);
     Py_DECREF(self->program_cache);
     Py_DECREF(self->shader_cache);
+    Py_DECREF(self->source_cache);
     Py_DECREF(self->includes);
     Py_DECREF(self->info);
+    Py_DECREF(self->ring_buffers);
+    Py_DECREF(self->transient_images);
+    Py_DECREF(self->transient_frame);
+    Py_DECREF(self->transient_framebuffers);
+    Py_XDECREF(self->program_binary_path);
+    Py_XDECREF(self->memory_hook);
+    free(self->scratch);
+    free(self->pixel_buffers);
+    free(self->query_pool);
+    PyThread_free_lock(self->lock);
     Py_TYPE(self)->tp_free(self);
 }
 
@@ -1973,7 +6456,7 @@ void Buffer_dealloc(Buffer * self) {
 
 void Image_dealloc(Image * self) {
     Py_DECREF(self->ctx);
-    Py_DECREF(self->framebuffer);
+    Py_XDECREF(self->framebuffer);
     Py_DECREF(self->size);
     Py_TYPE(self)->tp_free(self);
 }
@@ -1986,22 +6469,82 @@ void Pipeline_dealloc(Pipeline * self) {
     Py_DECREF(self->framebuffer);
     Py_DECREF(self->program);
     Py_DECREF(self->vertex_array);
+    free(self->profile_queries);
+    Py_TYPE(self)->tp_free(self);
+}
+
+void BufferPool_dealloc(BufferPool * self) {
+    free(self->blocks);
+    Py_DECREF(self->buffer);
+    Py_DECREF(self->ctx);
+    Py_TYPE(self)->tp_free(self);
+}
+
+void BufferSlice_dealloc(BufferSlice * self) {
+    Py_DECREF(self->buffer);
+    Py_DECREF(self->pool);
+    Py_TYPE(self)->tp_free(self);
+}
+
+void AsyncRead_dealloc(AsyncRead * self) {
+    if (self->pixel_buffer.buffer) {
+        give_pixel_buffer(self->ctx, self->pixel_buffer);
+    }
+    Py_XDECREF(self->result);
+    Py_DECREF(self->ctx);
+    Py_TYPE(self)->tp_free(self);
+}
+
+void Fence_dealloc(Fence * self) {
+    Py_DECREF(self->ctx);
+    Py_TYPE(self)->tp_free(self);
+}
+
+void RingBuffer_dealloc(RingBuffer * self) {
+    free(self->fences);
+    Py_DECREF(self->buffer);
+    Py_DECREF(self->ctx);
+    Py_TYPE(self)->tp_free(self);
+}
+
+void Query_dealloc(Query * self) {
+    if (self->active) {
+        self->ctx->dropped_queries[query_slot(self->target)] = {self->query, self->target};
+        self->ctx->active_queries &= ~query_bit(self->target);
+    }
+    Py_DECREF(self->kind);
+    Py_DECREF(self->ctx);
+    Py_TYPE(self)->tp_free(self);
+}
+
+void CommandList_dealloc(CommandList * self) {
+    for (int i = 0; i < self->view_count; ++i) {
+        PyBuffer_Release(&self->views[i]);
+    }
+    free(self->views);
+    free(self->commands);
+    Py_DECREF(self->objects);
+    Py_DECREF(self->ctx);
     Py_TYPE(self)->tp_free(self);
 }
 
 void DescriptorSetBuffers_dealloc(DescriptorSetBuffers * self) {
+    Py_XDECREF(self->key);
     Py_TYPE(self)->tp_free(self);
 }
 
 void DescriptorSetImages_dealloc(DescriptorSetImages * self) {
+    Py_XDECREF(self->key);
     Py_TYPE(self)->tp_free(self);
 }
 
 void GlobalSettings_dealloc(GlobalSettings * self) {
+    Py_XDECREF(self->key);
     Py_TYPE(self)->tp_free(self);
 }
 
 void GLObject_dealloc(GLObject * self) {
+    Py_XDECREF(self->key);
     Py_TYPE(self)->tp_free(self);
 }
 
@@ -2009,19 +6552,42 @@ PyMethodDef Context_methods[] = {
     {"buffer", (PyCFunction)Context_meth_buffer, METH_VARARGS | METH_KEYWORDS, NULL},
     {"image", (PyCFunction)Context_meth_image, METH_VARARGS | METH_KEYWORDS, NULL},
     {"pipeline", (PyCFunction)Context_meth_pipeline, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"pipelines", (PyCFunction)Context_meth_pipelines, METH_O, NULL},
     {"clear_shader_cache", (PyCFunction)Context_meth_clear_shader_cache, METH_NOARGS, NULL},
     {"release", (PyCFunction)Context_meth_release, METH_O, NULL},
+    {"release_many", (PyCFunction)Context_meth_release_many, METH_O, NULL},
+    {"memory", (PyCFunction)Context_meth_memory, METH_NOARGS, NULL},
+    {"render", (PyCFunction)Context_meth_render, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"invalidate_state", (PyCFunction)Context_meth_invalidate_state, METH_NOARGS, NULL},
+    {"buffer_pool", (PyCFunction)Context_meth_buffer_pool, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"command_list", (PyCFunction)Context_meth_command_list, METH_NOARGS, NULL},
+    {"execute", (PyCFunction)Context_meth_execute, METH_O, NULL},
+    {"fence", (PyCFunction)Context_meth_fence, METH_NOARGS, NULL},
+    {"ring_buffer", (PyCFunction)Context_meth_ring_buffer, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"end_frame", (PyCFunction)Context_meth_end_frame, METH_NOARGS, NULL},
+    {"transient_image", (PyCFunction)Context_meth_transient_image, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"clear_transient_images", (PyCFunction)Context_meth_clear_transient_images, METH_NOARGS, NULL},
+    {"query", (PyCFunction)Context_meth_query, METH_O, NULL},
+    {"stats", (PyCFunction)Context_meth_stats, METH_NOARGS, NULL},
+    {"reset_stats", (PyCFunction)Context_meth_reset_stats, METH_NOARGS, NULL},
     {},
 };
 
 PyMemberDef Context_members[] = {
     {"includes", T_OBJECT_EX, offsetof(Context, includes), READONLY, NULL},
     {"info", T_OBJECT_EX, offsetof(Context, info), READONLY, NULL},
+    {"memory_hook", T_OBJECT, offsetof(Context, memory_hook), 0, NULL},
+    {},
+};
+
+PyGetSetDef Context_getset[] = {
+    {"memory_budget", (getter)Context_get_memory_budget, (setter)Context_set_memory_budget, NULL, NULL},
     {},
 };
 
 PyMethodDef Buffer_methods[] = {
     {"write", (PyCFunction)Buffer_meth_write, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"copy_to", (PyCFunction)Buffer_meth_copy_to, METH_VARARGS | METH_KEYWORDS, NULL},
     {"map", (PyCFunction)Buffer_meth_map, METH_VARARGS | METH_KEYWORDS, NULL},
     {"unmap", (PyCFunction)Buffer_meth_unmap, METH_NOARGS, NULL},
     {},
@@ -2035,9 +6601,16 @@ PyMemberDef Buffer_members[] = {
 PyMethodDef Image_methods[] = {
     {"clear", (PyCFunction)Image_meth_clear, METH_NOARGS, NULL},
     {"write", (PyCFunction)Image_meth_write, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"map", (PyCFunction)Image_meth_map, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"unmap", (PyCFunction)Image_meth_unmap, METH_NOARGS, NULL},
     {"read", (PyCFunction)Image_meth_read, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"read_async", (PyCFunction)Image_meth_read_async, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"read_into", (PyCFunction)Image_meth_read_into, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"write_from_buffer", (PyCFunction)Image_meth_write_from_buffer, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"read_to_buffer", (PyCFunction)Image_meth_read_to_buffer, METH_VARARGS | METH_KEYWORDS, NULL},
     {"mipmaps", (PyCFunction)Image_meth_mipmaps, METH_VARARGS | METH_KEYWORDS, NULL},
     {"blit", (PyCFunction)Image_meth_blit, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"copy", (PyCFunction)Image_meth_copy, METH_VARARGS | METH_KEYWORDS, NULL},
     {},
 };
 
@@ -2054,25 +6627,72 @@ PyMemberDef Image_members[] = {
 };
 
 PyMethodDef Pipeline_methods[] = {
-    {"render", (PyCFunction)Pipeline_meth_render, METH_NOARGS, NULL},
+    {"render", (PyCFunction)Pipeline_meth_render, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"render_occlusion", (PyCFunction)Pipeline_meth_render_occlusion, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"render_ranges", (PyCFunction)Pipeline_meth_render_ranges, METH_VARARGS | METH_KEYWORDS, NULL},
     {},
 };
 
 PyGetSetDef Pipeline_getset[] = {
     {"viewport", (getter)Pipeline_get_viewport, (setter)Pipeline_set_viewport, NULL, NULL},
+    {"gpu_time", (getter)Pipeline_get_gpu_time, NULL, NULL, NULL},
+    {"gpu_time_count", (getter)Pipeline_get_gpu_time_count, NULL, NULL, NULL},
     {},
 };
 
 PyMemberDef Pipeline_members[] = {
-    {"vertex_count", T_OBJECT_EX, offsetof(Pipeline, vertex_count), 0, NULL},
-    {"instance_count", T_OBJECT_EX, offsetof(Pipeline, instance_count), 0, NULL},
-    {"first_vertex", T_OBJECT_EX, offsetof(Pipeline, first_vertex), 0, NULL},
+    {"vertex_count", T_INT, offsetof(Pipeline, vertex_count), 0, NULL},
+    {"instance_count", T_INT, offsetof(Pipeline, instance_count), 0, NULL},
+    {"first_vertex", T_INT, offsetof(Pipeline, first_vertex), 0, NULL},
+    {"base_vertex", T_INT, offsetof(Pipeline, base_vertex), 0, NULL},
+    {"layer", T_INT, offsetof(Pipeline, layer), 0, NULL},
+    {},
+};
+
+PyMethodDef BufferPool_methods[] = {
+    {"alloc", (PyCFunction)BufferPool_meth_alloc, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"free", (PyCFunction)BufferPool_meth_free, METH_O, NULL},
+    {},
+};
+
+PyMemberDef BufferPool_members[] = {
+    {"buffer", T_OBJECT_EX, offsetof(BufferPool, buffer), READONLY, NULL},
+    {"used", T_INT, offsetof(BufferPool, used), READONLY, NULL},
+    {},
+};
+
+PyMemberDef BufferSlice_members[] = {
+    {"buffer", T_OBJECT_EX, offsetof(BufferSlice, buffer), READONLY, NULL},
+    {"offset", T_INT, offsetof(BufferSlice, offset), READONLY, NULL},
+    {"size", T_INT, offsetof(BufferSlice, size), READONLY, NULL},
+    {},
+};
+
+PyMethodDef AsyncRead_methods[] = {
+    {"ready", (PyCFunction)AsyncRead_meth_ready, METH_NOARGS, NULL},
+    {"wait", (PyCFunction)AsyncRead_meth_wait, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"result", (PyCFunction)AsyncRead_meth_result, METH_NOARGS, NULL},
+    {},
+};
+
+PyMethodDef CommandList_methods[] = {
+    {"render", (PyCFunction)CommandList_meth_render, METH_O, NULL},
+    {"viewport", (PyCFunction)CommandList_meth_viewport, METH_VARARGS, NULL},
+    {"clear", (PyCFunction)CommandList_meth_clear, METH_O, NULL},
+    {"blit", (PyCFunction)CommandList_meth_blit, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"write", (PyCFunction)CommandList_meth_write, METH_VARARGS | METH_KEYWORDS, NULL},
+    {},
+};
+
+PyMemberDef CommandList_members[] = {
+    {"count", T_INT, offsetof(CommandList, count), READONLY, NULL},
     {},
 };
 
 PyType_Slot Context_slots[] = {
     {Py_tp_methods, Context_methods},
     {Py_tp_members, Context_members},
+    {Py_tp_getset, Context_getset},
     {Py_tp_dealloc, (void *)Context_dealloc},
     {},
 };
@@ -2100,6 +6720,91 @@ PyType_Slot Pipeline_slots[] = {
     {},
 };
 
+PyType_Slot BufferPool_slots[] = {
+    {Py_tp_methods, BufferPool_methods},
+    {Py_tp_members, BufferPool_members},
+    {Py_tp_dealloc, (void *)BufferPool_dealloc},
+    {},
+};
+
+PyType_Slot BufferSlice_slots[] = {
+    {Py_tp_members, BufferSlice_members},
+    {Py_tp_dealloc, (void *)BufferSlice_dealloc},
+    {},
+};
+
+PyMethodDef Fence_methods[] = {
+    {"client_wait", (PyCFunction)Fence_meth_client_wait, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"wait", (PyCFunction)Fence_meth_wait, METH_NOARGS, NULL},
+    {},
+};
+
+PyGetSetDef Fence_getset[] = {
+    {"signaled", (getter)Fence_get_signaled, NULL, NULL, NULL},
+    {},
+};
+
+PyMethodDef RingBuffer_methods[] = {
+    {"write", (PyCFunction)RingBuffer_meth_write, METH_O, NULL},
+    {"next_frame", (PyCFunction)RingBuffer_meth_next_frame, METH_NOARGS, NULL},
+    {},
+};
+
+PyMemberDef RingBuffer_members[] = {
+    {"buffer", T_OBJECT_EX, offsetof(RingBuffer, buffer), READONLY, NULL},
+    {"size", T_INT, offsetof(RingBuffer, size), READONLY, NULL},
+    {"frames", T_INT, offsetof(RingBuffer, frames), READONLY, NULL},
+    {"frame", T_INT, offsetof(RingBuffer, frame), READONLY, NULL},
+    {"used", T_INT, offsetof(RingBuffer, used), READONLY, NULL},
+    {},
+};
+
+PyType_Slot RingBuffer_slots[] = {
+    {Py_tp_methods, RingBuffer_methods},
+    {Py_tp_members, RingBuffer_members},
+    {Py_tp_dealloc, (void *)RingBuffer_dealloc},
+    {},
+};
+
+PyMethodDef Query_methods[] = {
+    {"begin", (PyCFunction)Query_meth_begin, METH_NOARGS, NULL},
+    {"end", (PyCFunction)Query_meth_end, METH_NOARGS, NULL},
+    {"result", (PyCFunction)Query_meth_result, METH_VARARGS | METH_KEYWORDS, NULL},
+    {},
+};
+
+PyMemberDef Query_members[] = {
+    {"kind", T_OBJECT_EX, offsetof(Query, kind), READONLY, NULL},
+    {},
+};
+
+PyType_Slot Query_slots[] = {
+    {Py_tp_methods, Query_methods},
+    {Py_tp_members, Query_members},
+    {Py_tp_dealloc, (void *)Query_dealloc},
+    {},
+};
+
+PyType_Slot Fence_slots[] = {
+    {Py_tp_methods, Fence_methods},
+    {Py_tp_getset, Fence_getset},
+    {Py_tp_dealloc, (void *)Fence_dealloc},
+    {},
+};
+
+PyType_Slot AsyncRead_slots[] = {
+    {Py_tp_methods, AsyncRead_methods},
+    {Py_tp_dealloc, (void *)AsyncRead_dealloc},
+    {},
+};
+
+PyType_Slot CommandList_slots[] = {
+    {Py_tp_methods, CommandList_methods},
+    {Py_tp_members, CommandList_members},
+    {Py_tp_dealloc, (void *)CommandList_dealloc},
+    {},
+};
+
 PyType_Slot DescriptorSetBuffers_slots[] = {
     {Py_tp_dealloc, (void *)DescriptorSetBuffers_dealloc},
     {},
@@ -2124,11 +6829,34 @@ PyType_Spec Context_spec = {"zengl.Context", sizeof(Context), 0, Py_TPFLAGS_DEFA
 PyType_Spec Buffer_spec = {"zengl.Buffer", sizeof(Buffer), 0, Py_TPFLAGS_DEFAULT, Buffer_slots};
 PyType_Spec Image_spec = {"zengl.Image", sizeof(Image), 0, Py_TPFLAGS_DEFAULT, Image_slots};
 PyType_Spec Pipeline_spec = {"zengl.Pipeline", sizeof(Pipeline), 0, Py_TPFLAGS_DEFAULT, Pipeline_slots};
+PyType_Spec BufferPool_spec = {"zengl.BufferPool", sizeof(BufferPool), 0, Py_TPFLAGS_DEFAULT, BufferPool_slots};
+PyType_Spec BufferSlice_spec = {"zengl.BufferSlice", sizeof(BufferSlice), 0, Py_TPFLAGS_DEFAULT, BufferSlice_slots};
+PyType_Spec AsyncRead_spec = {"zengl.AsyncRead", sizeof(AsyncRead), 0, Py_TPFLAGS_DEFAULT, AsyncRead_slots};
+PyType_Spec RingBuffer_spec = {"zengl.RingBuffer", sizeof(RingBuffer), 0, Py_TPFLAGS_DEFAULT, RingBuffer_slots};
+PyType_Spec Query_spec = {"zengl.Query", sizeof(Query), 0, Py_TPFLAGS_DEFAULT, Query_slots};
+PyType_Spec Fence_spec = {"zengl.Fence", sizeof(Fence), 0, Py_TPFLAGS_DEFAULT, Fence_slots};
+PyType_Spec CommandList_spec = {"zengl.CommandList", sizeof(CommandList), 0, Py_TPFLAGS_DEFAULT, CommandList_slots};
 PyType_Spec DescriptorSetBuffers_spec = {"zengl.DescriptorSetBuffers", sizeof(DescriptorSetBuffers), 0, Py_TPFLAGS_DEFAULT, DescriptorSetBuffers_slots};
 PyType_Spec DescriptorSetImages_spec = {"zengl.DescriptorSetImages", sizeof(DescriptorSetImages), 0, Py_TPFLAGS_DEFAULT, DescriptorSetImages_slots};
 PyType_Spec GlobalSettings_spec = {"zengl.GlobalSettings", sizeof(GlobalSettings), 0, Py_TPFLAGS_DEFAULT, GlobalSettings_slots};
 PyType_Spec GLObject_spec = {"zengl.GLObject", sizeof(GLObject), 0, Py_TPFLAGS_DEFAULT, GLObject_slots};
 
+void set_enum(PyObject * table, const char * name, int value) {
+    PyObject * key = PyUnicode_InternFromString(name);
+    PyObject * item = PyLong_FromLong(value);
+    PyDict_SetItem(table, key, item);
+    Py_DECREF(key);
+    Py_DECREF(item);
+}
+
+PyObject * build_enum_table(const NamedEnum * items, int count) {
+    PyObject * res = PyDict_New();
+    for (int i = 0; i < count; ++i) {
+        set_enum(res, items[i].name, items[i].value);
+    }
+    return res;
+}
+
 int module_exec(PyObject * self) {
     ModuleState * state = (ModuleState *)PyModule_GetState(self);
 
@@ -2142,10 +6870,36 @@ int module_exec(PyObject * self) {
     state->str_ccw = PyUnicode_FromString("ccw");
     state->float_one = PyFloat_FromDouble(1.0);
     state->default_color_mask = PyLong_FromUnsignedLongLong(0xffffffffffffffffull);
+    state->vertex_format_table = PyDict_New();
+    for (int i = 0; i < (int)(sizeof(vertex_formats) / sizeof(NamedVertexFormat)); ++i) {
+        set_enum(state->vertex_format_table, vertex_formats[i].name, i);
+    }
+    state->image_format_table = PyDict_New();
+    for (int i = 0; i < (int)(sizeof(image_formats) / sizeof(NamedImageFormat)); ++i) {
+        set_enum(state->image_format_table, image_formats[i].name, i);
+    }
+    state->topology_table = build_enum_table(topologies, (int)(sizeof(topologies) / sizeof(NamedEnum)));
+    state->front_face_table = build_enum_table(front_faces, (int)(sizeof(front_faces) / sizeof(NamedEnum)));
+    state->cull_face_table = build_enum_table(cull_faces, (int)(sizeof(cull_faces) / sizeof(NamedEnum)));
+    state->min_filter_table = build_enum_table(min_filters, (int)(sizeof(min_filters) / sizeof(NamedEnum)));
+    state->mag_filter_table = build_enum_table(mag_filters, (int)(sizeof(mag_filters) / sizeof(NamedEnum)));
+    state->texture_wrap_table = build_enum_table(texture_wraps, (int)(sizeof(texture_wraps) / sizeof(NamedEnum)));
+    state->compare_mode_table = build_enum_table(compare_modes, (int)(sizeof(compare_modes) / sizeof(NamedEnum)));
+    state->compare_func_table = build_enum_table(compare_funcs, (int)(sizeof(compare_funcs) / sizeof(NamedEnum)));
+    state->blend_constant_table = build_enum_table(blend_constants, (int)(sizeof(blend_constants) / sizeof(NamedEnum)));
+    state->stencil_op_table = build_enum_table(stencil_ops, (int)(sizeof(stencil_ops) / sizeof(NamedEnum)));
+    state->vertex_step_table = build_enum_table(vertex_steps, (int)(sizeof(vertex_steps) / sizeof(NamedEnum)));
     state->Context_type = (PyTypeObject *)PyType_FromSpec(&Context_spec);
     state->Buffer_type = (PyTypeObject *)PyType_FromSpec(&Buffer_spec);
     state->Image_type = (PyTypeObject *)PyType_FromSpec(&Image_spec);
     state->Pipeline_type = (PyTypeObject *)PyType_FromSpec(&Pipeline_spec);
+    state->BufferPool_type = (PyTypeObject *)PyType_FromSpec(&BufferPool_spec);
+    state->BufferSlice_type = (PyTypeObject *)PyType_FromSpec(&BufferSlice_spec);
+    state->CommandList_type = (PyTypeObject *)PyType_FromSpec(&CommandList_spec);
+    state->AsyncRead_type = (PyTypeObject *)PyType_FromSpec(&AsyncRead_spec);
+    state->Fence_type = (PyTypeObject *)PyType_FromSpec(&Fence_spec);
+    state->RingBuffer_type = (PyTypeObject *)PyType_FromSpec(&RingBuffer_spec);
+    state->Query_type = (PyTypeObject *)PyType_FromSpec(&Query_spec);
     state->DescriptorSetBuffers_type = (PyTypeObject *)PyType_FromSpec(&DescriptorSetBuffers_spec);
     state->DescriptorSetImages_type = (PyTypeObject *)PyType_FromSpec(&DescriptorSetImages_spec);
     state->GlobalSettings_type = (PyTypeObject *)PyType_FromSpec(&GlobalSettings_spec);
@@ -2155,6 +6909,13 @@ int module_exec(PyObject * self) {
     PyModule_AddObject(self, "Buffer", (PyObject *)state->Buffer_type);
     PyModule_AddObject(self, "Image", (PyObject *)state->Image_type);
     PyModule_AddObject(self, "Pipeline", (PyObject *)state->Pipeline_type);
+    PyModule_AddObject(self, "BufferPool", (PyObject *)state->BufferPool_type);
+    PyModule_AddObject(self, "BufferSlice", (PyObject *)state->BufferSlice_type);
+    PyModule_AddObject(self, "CommandList", (PyObject *)state->CommandList_type);
+    PyModule_AddObject(self, "AsyncRead", (PyObject *)state->AsyncRead_type);
+    PyModule_AddObject(self, "Fence", (PyObject *)state->Fence_type);
+    PyModule_AddObject(self, "RingBuffer", (PyObject *)state->RingBuffer_type);
+    PyModule_AddObject(self, "Query", (PyObject *)state->Query_type);
 
     PyModule_AddObject(self, "loader", (PyObject *)new_ref(PyObject_GetAttrString(state->helper, "loader")));
     PyModule_AddObject(self, "calcsize", (PyObject *)new_ref(PyObject_GetAttrString(state->helper, "calcsize")));
@@ -2186,10 +6947,30 @@ void module_free(PyObject * self) {
     Py_DECREF(state->str_ccw);
     Py_DECREF(state->float_one);
     Py_DECREF(state->default_color_mask);
+    Py_DECREF(state->vertex_format_table);
+    Py_DECREF(state->image_format_table);
+    Py_DECREF(state->topology_table);
+    Py_DECREF(state->front_face_table);
+    Py_DECREF(state->cull_face_table);
+    Py_DECREF(state->min_filter_table);
+    Py_DECREF(state->mag_filter_table);
+    Py_DECREF(state->texture_wrap_table);
+    Py_DECREF(state->compare_mode_table);
+    Py_DECREF(state->compare_func_table);
+    Py_DECREF(state->blend_constant_table);
+    Py_DECREF(state->stencil_op_table);
+    Py_DECREF(state->vertex_step_table);
     Py_DECREF(state->Context_type);
     Py_DECREF(state->Buffer_type);
     Py_DECREF(state->Image_type);
     Py_DECREF(state->Pipeline_type);
+    Py_DECREF(state->BufferPool_type);
+    Py_DECREF(state->BufferSlice_type);
+    Py_DECREF(state->CommandList_type);
+    Py_DECREF(state->AsyncRead_type);
+    Py_DECREF(state->Fence_type);
+    Py_DECREF(state->RingBuffer_type);
+    Py_DECREF(state->Query_type);
     Py_DECREF(state->DescriptorSetBuffers_type);
     Py_DECREF(state->DescriptorSetImages_type);
     Py_DECREF(state->GlobalSettings_type);
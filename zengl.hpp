@@ -4,6 +4,9 @@
 const int MAX_ATTACHMENTS = 16;
 const int MAX_UNIFORM_BUFFER_BINDINGS = 16;
 const int MAX_SAMPLER_BINDINGS = 64;
+const int MIN_ALLOW_THREADS_SIZE = 0x10000;
+const int UNPACK_RING_SIZE = 3;
+const int QUERY_SLOTS = 4;
 
 #if defined(_WIN32) || defined(_WIN64)
 #define GLAPI __stdcall
@@ -12,6 +15,10 @@ const int MAX_SAMPLER_BINDINGS = 64;
 #endif
 
 // GL_VERSION_1_0
+#define GL_ZERO 0
+#define GL_ONE 1
+#define GL_DEPTH_BUFFER_BIT 0x00000100
+#define GL_STENCIL_BUFFER_BIT 0x00000400
 #define GL_COLOR_BUFFER_BIT 0x00004000
 #define GL_POINTS 0x0000
 #define GL_LINES 0x0001
@@ -20,13 +27,36 @@ const int MAX_SAMPLER_BINDINGS = 64;
 #define GL_TRIANGLES 0x0004
 #define GL_TRIANGLE_STRIP 0x0005
 #define GL_TRIANGLE_FAN 0x0006
+#define GL_NEVER 0x0200
+#define GL_LESS 0x0201
+#define GL_EQUAL 0x0202
+#define GL_LEQUAL 0x0203
+#define GL_GREATER 0x0204
+#define GL_NOTEQUAL 0x0205
+#define GL_GEQUAL 0x0206
+#define GL_ALWAYS 0x0207
+#define GL_SRC_COLOR 0x0300
+#define GL_ONE_MINUS_SRC_COLOR 0x0301
+#define GL_SRC_ALPHA 0x0302
+#define GL_ONE_MINUS_SRC_ALPHA 0x0303
+#define GL_DST_ALPHA 0x0304
+#define GL_ONE_MINUS_DST_ALPHA 0x0305
+#define GL_DST_COLOR 0x0306
+#define GL_ONE_MINUS_DST_COLOR 0x0307
+#define GL_SRC_ALPHA_SATURATE 0x0308
 #define GL_FRONT 0x0404
 #define GL_BACK 0x0405
+#define GL_FRONT_AND_BACK 0x0408
+#define GL_CW 0x0900
+#define GL_CCW 0x0901
 #define GL_CULL_FACE 0x0B44
 #define GL_DEPTH_TEST 0x0B71
 #define GL_STENCIL_TEST 0x0B90
 #define GL_BLEND 0x0BE2
 #define GL_TEXTURE_2D 0x0DE1
+#define GL_UNPACK_ALIGNMENT 0x0CF5
+#define GL_PACK_ROW_LENGTH 0x0D02
+#define GL_PACK_ALIGNMENT 0x0D05
 #define GL_TEXTURE_BORDER_COLOR 0x1004
 #define GL_BYTE 0x1400
 #define GL_UNSIGNED_BYTE 0x1401
@@ -35,6 +65,7 @@ const int MAX_SAMPLER_BINDINGS = 64;
 #define GL_INT 0x1404
 #define GL_UNSIGNED_INT 0x1405
 #define GL_FLOAT 0x1406
+#define GL_INVERT 0x150A
 #define GL_COLOR 0x1800
 #define GL_DEPTH 0x1801
 #define GL_STENCIL 0x1802
@@ -45,12 +76,22 @@ const int MAX_SAMPLER_BINDINGS = 64;
 #define GL_VENDOR 0x1F00
 #define GL_RENDERER 0x1F01
 #define GL_VERSION 0x1F02
+#define GL_EXTENSIONS 0x1F03
+#define GL_KEEP 0x1E00
+#define GL_REPLACE 0x1E01
+#define GL_INCR 0x1E02
+#define GL_DECR 0x1E03
 #define GL_NEAREST 0x2600
 #define GL_LINEAR 0x2601
+#define GL_NEAREST_MIPMAP_NEAREST 0x2700
+#define GL_LINEAR_MIPMAP_NEAREST 0x2701
+#define GL_NEAREST_MIPMAP_LINEAR 0x2702
+#define GL_LINEAR_MIPMAP_LINEAR 0x2703
 #define GL_TEXTURE_MAG_FILTER 0x2800
 #define GL_TEXTURE_MIN_FILTER 0x2801
 #define GL_TEXTURE_WRAP_S 0x2802
 #define GL_TEXTURE_WRAP_T 0x2803
+#define GL_REPEAT 0x2901
 
 // GL_VERSION_1_1
 #define GL_POLYGON_OFFSET_POINT 0x2A01
@@ -61,6 +102,11 @@ const int MAX_SAMPLER_BINDINGS = 64;
 // GL_VERSION_1_2
 #define GL_TEXTURE_WRAP_R 0x8072
 #define GL_BGRA 0x80E1
+#define GL_CLAMP_TO_EDGE 0x812F
+#define GL_CONSTANT_COLOR 0x8001
+#define GL_ONE_MINUS_CONSTANT_COLOR 0x8002
+#define GL_CONSTANT_ALPHA 0x8003
+#define GL_ONE_MINUS_CONSTANT_ALPHA 0x8004
 #define GL_TEXTURE_MIN_LOD 0x813A
 #define GL_TEXTURE_MAX_LOD 0x813B
 #define GL_TEXTURE_BASE_LEVEL 0x813C
@@ -74,15 +120,25 @@ const int MAX_SAMPLER_BINDINGS = 64;
 // GL_VERSION_1_4
 #define GL_DEPTH_COMPONENT16 0x81A5
 #define GL_DEPTH_COMPONENT24 0x81A6
+#define GL_MIRRORED_REPEAT 0x8370
+#define GL_INCR_WRAP 0x8507
+#define GL_DECR_WRAP 0x8508
 #define GL_TEXTURE_LOD_BIAS 0x8501
 #define GL_TEXTURE_COMPARE_MODE 0x884C
 #define GL_TEXTURE_COMPARE_FUNC 0x884D
+#define GL_COMPARE_REF_TO_TEXTURE 0x884E
 
 // GL_VERSION_1_5
 #define GL_ARRAY_BUFFER 0x8892
 #define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_STREAM_DRAW 0x88E0
+#define GL_STREAM_READ 0x88E1
 #define GL_STATIC_DRAW 0x88E4
 #define GL_DYNAMIC_DRAW 0x88E8
+#define GL_QUERY_RESULT 0x8866
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#define GL_SAMPLES_PASSED 0x8914
+#define GL_SRC1_ALPHA 0x8589
 
 // GL_VERSION_2_0
 #define GL_MAX_TEXTURE_IMAGE_UNITS 0x8872
@@ -95,6 +151,8 @@ const int MAX_SAMPLER_BINDINGS = 64;
 #define GL_ACTIVE_ATTRIBUTES 0x8B89
 
 // GL_VERSION_2_1
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
 #define GL_SRGB8_ALPHA8 0x8C43
 
 // GL_VERSION_3_0
@@ -124,6 +182,11 @@ const int MAX_SAMPLER_BINDINGS = 64;
 #define GL_MAP_READ_BIT 0x0001
 #define GL_MAP_WRITE_BIT 0x0002
 #define GL_MAP_INVALIDATE_RANGE_BIT 0x0004
+#define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+#define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
+#define GL_MAJOR_VERSION 0x821B
+#define GL_MINOR_VERSION 0x821C
+#define GL_NUM_EXTENSIONS 0x821D
 #define GL_RG 0x8227
 #define GL_R8 0x8229
 #define GL_RG8 0x822B
@@ -143,6 +206,8 @@ const int MAX_SAMPLER_BINDINGS = 64;
 #define GL_RG16UI 0x823A
 #define GL_RG32I 0x823B
 #define GL_RG32UI 0x823C
+#define GL_PRIMITIVES_GENERATED 0x8C87
+#define GL_QUERY_WAIT 0x8E13
 
 // GL_VERSION_3_1
 #define GL_R8_SNORM 0x8F94
@@ -150,12 +215,42 @@ const int MAX_SAMPLER_BINDINGS = 64;
 #define GL_RGBA8_SNORM 0x8F97
 #define GL_PRIMITIVE_RESTART 0x8F9D
 #define GL_UNIFORM_BUFFER 0x8A11
+#define GL_COPY_READ_BUFFER 0x8F36
+#define GL_COPY_WRITE_BUFFER 0x8F37
 #define GL_ACTIVE_UNIFORM_BLOCKS 0x8A36
 #define GL_UNIFORM_BLOCK_DATA_SIZE 0x8A40
+#define GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT 0x8A34
 
 // GL_VERSION_3_2
 #define GL_PROGRAM_POINT_SIZE 0x8642
 #define GL_TEXTURE_CUBE_MAP_SEAMLESS 0x884F
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_ALREADY_SIGNALED 0x911A
+#define GL_TIMEOUT_EXPIRED 0x911B
+#define GL_CONDITION_SATISFIED 0x911C
+#define GL_WAIT_FAILED 0x911D
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define GL_TIMEOUT_IGNORED 0xFFFFFFFFFFFFFFFFull
+
+// GL_VERSION_3_3
+#define GL_SRC1_COLOR 0x88F9
+#define GL_ONE_MINUS_SRC1_COLOR 0x88FA
+#define GL_ONE_MINUS_SRC1_ALPHA 0x88FB
+#define GL_TIME_ELAPSED 0x88BF
+#define GL_TIMESTAMP 0x8E28
+#define GL_ANY_SAMPLES_PASSED 0x8C2F
+
+// GL_VERSION_4_1
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+
+// GL_VERSION_4_4
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+
+// KHR_parallel_shader_compile
+#define GL_COMPLETION_STATUS 0x91B1
 
 // GL_VERSION_1_0
 typedef void (GLAPI * glCullFaceProc)(unsigned int mode);
@@ -167,6 +262,7 @@ typedef void (GLAPI * glDepthMaskProc)(unsigned char flag);
 typedef void (GLAPI * glDisableProc)(unsigned int cap);
 typedef void (GLAPI * glEnableProc)(unsigned int cap);
 typedef void (GLAPI * glDepthFuncProc)(unsigned int func);
+typedef void (GLAPI * glPixelStoreiProc)(unsigned int pname, int param);
 typedef void (GLAPI * glReadBufferProc)(unsigned int src);
 typedef void (GLAPI * glReadPixelsProc)(int x, int y, int width, int height, unsigned int format, unsigned int type, void * pixels);
 typedef unsigned int (GLAPI * glGetErrorProc)();
@@ -177,6 +273,7 @@ typedef void (GLAPI * glViewportProc)(int x, int y, int width, int height);
 // GL_VERSION_1_1
 typedef void (GLAPI * glPolygonOffsetProc)(float factor, float units);
 typedef void (GLAPI * glTexSubImage2DProc)(unsigned int target, int level, int xoffset, int yoffset, int width, int height, unsigned int format, unsigned int type, const void * pixels);
+typedef void (GLAPI * glCopyTexSubImage2DProc)(unsigned int target, int level, int xoffset, int yoffset, int x, int y, int width, int height);
 typedef void (GLAPI * glBindTextureProc)(unsigned int target, unsigned int texture);
 typedef void (GLAPI * glDeleteTexturesProc)(int n, const unsigned int * textures);
 typedef void (GLAPI * glGenTexturesProc)(int n, unsigned int * textures);
@@ -184,12 +281,15 @@ typedef void (GLAPI * glGenTexturesProc)(int n, unsigned int * textures);
 // GL_VERSION_1_2
 typedef void (GLAPI * glTexImage3DProc)(unsigned int target, int level, int internalformat, int width, int height, int depth, int border, unsigned int format, unsigned int type, const void * pixels);
 typedef void (GLAPI * glTexSubImage3DProc)(unsigned int target, int level, int xoffset, int yoffset, int zoffset, int width, int height, int depth, unsigned int format, unsigned int type, const void * pixels);
+typedef void (GLAPI * glCopyTexSubImage3DProc)(unsigned int target, int level, int xoffset, int yoffset, int zoffset, int x, int y, int width, int height);
 
 // GL_VERSION_1_3
 typedef void (GLAPI * glActiveTextureProc)(unsigned int texture);
 
 // GL_VERSION_1_4
 typedef void (GLAPI * glBlendFuncSeparateProc)(unsigned int sfactorRGB, unsigned int dfactorRGB, unsigned int sfactorAlpha, unsigned int dfactorAlpha);
+typedef void (GLAPI * glMultiDrawArraysProc)(unsigned int mode, const int * first, const int * count, int drawcount);
+typedef void (GLAPI * glMultiDrawElementsProc)(unsigned int mode, const int * count, unsigned int type, const void * const * indices, int drawcount);
 
 // GL_VERSION_1_5
 typedef void (GLAPI * glBindBufferProc)(unsigned int target, unsigned int buffer);
@@ -198,6 +298,11 @@ typedef void (GLAPI * glGenBuffersProc)(int n, unsigned int * buffers);
 typedef void (GLAPI * glBufferDataProc)(unsigned int target, long long int size, const void * data, unsigned int usage);
 typedef void (GLAPI * glBufferSubDataProc)(unsigned int target, long long int offset, long long int size, const void * data);
 typedef unsigned char (GLAPI * glUnmapBufferProc)(unsigned int target);
+typedef void (GLAPI * glGenQueriesProc)(int n, unsigned int * ids);
+typedef void (GLAPI * glDeleteQueriesProc)(int n, const unsigned int * ids);
+typedef void (GLAPI * glBeginQueryProc)(unsigned int target, unsigned int id);
+typedef void (GLAPI * glEndQueryProc)(unsigned int target);
+typedef void (GLAPI * glGetQueryObjectivProc)(unsigned int id, unsigned int pname, int * params);
 
 // GL_VERSION_2_0
 typedef void (GLAPI * glDrawBuffersProc)(int n, const unsigned int * bufs);
@@ -244,9 +349,13 @@ typedef void (GLAPI * glGenFramebuffersProc)(int n, unsigned int * framebuffers)
 typedef void (GLAPI * glFramebufferTexture2DProc)(unsigned int target, unsigned int attachment, unsigned int textarget, unsigned int texture, int level);
 typedef void (GLAPI * glFramebufferRenderbufferProc)(unsigned int target, unsigned int attachment, unsigned int renderbuffertarget, unsigned int renderbuffer);
 typedef void (GLAPI * glGenerateMipmapProc)(unsigned int target);
+typedef void (GLAPI * glFramebufferTextureLayerProc)(unsigned int target, unsigned int attachment, unsigned int texture, int level, int layer);
 typedef void (GLAPI * glBlitFramebufferProc)(int srcX0, int srcY0, int srcX1, int srcY1, int dstX0, int dstY0, int dstX1, int dstY1, unsigned int mask, unsigned int filter);
 typedef void (GLAPI * glRenderbufferStorageMultisampleProc)(unsigned int target, int samples, unsigned int internalformat, int width, int height);
 typedef void * (GLAPI * glMapBufferRangeProc)(unsigned int target, long long int offset, long long int length, unsigned int access);
+typedef const unsigned char * (GLAPI * glGetStringiProc)(unsigned int name, unsigned int index);
+typedef void (GLAPI * glBeginConditionalRenderProc)(unsigned int id, unsigned int mode);
+typedef void (GLAPI * glEndConditionalRenderProc)();
 typedef void (GLAPI * glBindVertexArrayProc)(unsigned int array);
 typedef void (GLAPI * glDeleteVertexArraysProc)(int n, const unsigned int * arrays);
 typedef void (GLAPI * glGenVertexArraysProc)(int n, unsigned int * arrays);
@@ -255,11 +364,20 @@ typedef void (GLAPI * glGenVertexArraysProc)(int n, unsigned int * arrays);
 typedef void (GLAPI * glDrawArraysInstancedProc)(unsigned int mode, int first, int count, int instancecount);
 typedef void (GLAPI * glDrawElementsInstancedProc)(unsigned int mode, int count, unsigned int type, const void * indices, int instancecount);
 typedef void (GLAPI * glPrimitiveRestartIndexProc)(unsigned int index);
+typedef void (GLAPI * glCopyBufferSubDataProc)(unsigned int readTarget, unsigned int writeTarget, long long int readOffset, long long int writeOffset, long long int size);
 typedef unsigned int (GLAPI * glGetUniformBlockIndexProc)(unsigned int program, const char * uniformBlockName);
 typedef void (GLAPI * glGetActiveUniformBlockivProc)(unsigned int program, unsigned int uniformBlockIndex, unsigned int pname, int * params);
 typedef void (GLAPI * glGetActiveUniformBlockNameProc)(unsigned int program, unsigned int uniformBlockIndex, int bufSize, int * length, char * uniformBlockName);
 typedef void (GLAPI * glUniformBlockBindingProc)(unsigned int program, unsigned int uniformBlockIndex, unsigned int uniformBlockBinding);
 
+// GL_VERSION_3_2
+typedef void (GLAPI * glDrawElementsInstancedBaseVertexProc)(unsigned int mode, int count, unsigned int type, const void * indices, int instancecount, int basevertex);
+typedef void * (GLAPI * glFenceSyncProc)(unsigned int condition, unsigned int flags);
+typedef void (GLAPI * glDeleteSyncProc)(void * sync);
+typedef unsigned int (GLAPI * glClientWaitSyncProc)(void * sync, unsigned int flags, unsigned long long timeout);
+typedef void (GLAPI * glWaitSyncProc)(void * sync, unsigned int flags, unsigned long long timeout);
+typedef void (GLAPI * glMultiDrawElementsBaseVertexProc)(unsigned int mode, const int * count, unsigned int type, const void * const * indices, int drawcount, const int * basevertex);
+
 // GL_VERSION_3_3
 typedef void (GLAPI * glGenSamplersProc)(int count, unsigned int * samplers);
 typedef void (GLAPI * glDeleteSamplersProc)(int count, const unsigned int * samplers);
@@ -268,6 +386,19 @@ typedef void (GLAPI * glSamplerParameteriProc)(unsigned int sampler, unsigned in
 typedef void (GLAPI * glSamplerParameterfProc)(unsigned int sampler, unsigned int pname, float param);
 typedef void (GLAPI * glSamplerParameterfvProc)(unsigned int sampler, unsigned int pname, const float * param);
 typedef void (GLAPI * glVertexAttribDivisorProc)(unsigned int index, unsigned int divisor);
+typedef void (GLAPI * glQueryCounterProc)(unsigned int id, unsigned int target);
+typedef void (GLAPI * glGetQueryObjectui64vProc)(unsigned int id, unsigned int pname, unsigned long long * params);
+
+// GL_VERSION_4_1
+typedef void (GLAPI * glGetProgramBinaryProc)(unsigned int program, int buf_size, int * length, unsigned int * binary_format, void * binary);
+typedef void (GLAPI * glProgramBinaryProc)(unsigned int program, unsigned int binary_format, const void * binary, int length);
+typedef void (GLAPI * glProgramParameteriProc)(unsigned int program, unsigned int pname, int value);
+
+// GL_VERSION_4_4
+typedef void (GLAPI * glBufferStorageProc)(unsigned int target, long long int size, const void * data, unsigned int flags);
+
+// KHR_parallel_shader_compile
+typedef void (GLAPI * glMaxShaderCompilerThreadsProc)(unsigned int count);
 
 struct GLMethods {
     // GL_VERSION_1_0
@@ -281,6 +412,7 @@ struct GLMethods {
     glEnableProc Enable;
     glDepthFuncProc DepthFunc;
     glReadBufferProc ReadBuffer;
+    glPixelStoreiProc PixelStorei;
     glReadPixelsProc ReadPixels;
     glGetErrorProc GetError;
     glGetIntegervProc GetIntegerv;
@@ -290,6 +422,7 @@ struct GLMethods {
     // GL_VERSION_1_1
     glPolygonOffsetProc PolygonOffset;
     glTexSubImage2DProc TexSubImage2D;
+    glCopyTexSubImage2DProc CopyTexSubImage2D;
     glBindTextureProc BindTexture;
     glDeleteTexturesProc DeleteTextures;
     glGenTexturesProc GenTextures;
@@ -297,12 +430,15 @@ struct GLMethods {
     // GL_VERSION_1_2
     glTexImage3DProc TexImage3D;
     glTexSubImage3DProc TexSubImage3D;
+    glCopyTexSubImage3DProc CopyTexSubImage3D;
 
     // GL_VERSION_1_3
     glActiveTextureProc ActiveTexture;
 
     // GL_VERSION_1_4
     glBlendFuncSeparateProc BlendFuncSeparate;
+    glMultiDrawArraysProc MultiDrawArrays;
+    glMultiDrawElementsProc MultiDrawElements;
 
     // GL_VERSION_1_5
     glBindBufferProc BindBuffer;
@@ -311,6 +447,11 @@ struct GLMethods {
     glBufferDataProc BufferData;
     glBufferSubDataProc BufferSubData;
     glUnmapBufferProc UnmapBuffer;
+    glGenQueriesProc GenQueries;
+    glDeleteQueriesProc DeleteQueries;
+    glBeginQueryProc BeginQuery;
+    glEndQueryProc EndQuery;
+    glGetQueryObjectivProc GetQueryObjectiv;
 
     // GL_VERSION_2_0
     glDrawBuffersProc DrawBuffers;
@@ -357,9 +498,13 @@ struct GLMethods {
     glFramebufferTexture2DProc FramebufferTexture2D;
     glFramebufferRenderbufferProc FramebufferRenderbuffer;
     glGenerateMipmapProc GenerateMipmap;
+    glFramebufferTextureLayerProc FramebufferTextureLayer;
     glBlitFramebufferProc BlitFramebuffer;
     glRenderbufferStorageMultisampleProc RenderbufferStorageMultisample;
     glMapBufferRangeProc MapBufferRange;
+    glGetStringiProc GetStringi;
+    glBeginConditionalRenderProc BeginConditionalRender;
+    glEndConditionalRenderProc EndConditionalRender;
     glBindVertexArrayProc BindVertexArray;
     glDeleteVertexArraysProc DeleteVertexArrays;
     glGenVertexArraysProc GenVertexArrays;
@@ -368,11 +513,20 @@ struct GLMethods {
     glDrawArraysInstancedProc DrawArraysInstanced;
     glDrawElementsInstancedProc DrawElementsInstanced;
     glPrimitiveRestartIndexProc PrimitiveRestartIndex;
+    glCopyBufferSubDataProc CopyBufferSubData;
     glGetUniformBlockIndexProc GetUniformBlockIndex;
     glGetActiveUniformBlockivProc GetActiveUniformBlockiv;
     glGetActiveUniformBlockNameProc GetActiveUniformBlockName;
     glUniformBlockBindingProc UniformBlockBinding;
 
+    // GL_VERSION_3_2
+    glDrawElementsInstancedBaseVertexProc DrawElementsInstancedBaseVertex;
+    glMultiDrawElementsBaseVertexProc MultiDrawElementsBaseVertex;
+    glFenceSyncProc FenceSync;
+    glDeleteSyncProc DeleteSync;
+    glClientWaitSyncProc ClientWaitSync;
+    glWaitSyncProc WaitSync;
+
     // GL_VERSION_3_3
     glGenSamplersProc GenSamplers;
     glDeleteSamplersProc DeleteSamplers;
@@ -381,6 +535,19 @@ struct GLMethods {
     glSamplerParameterfProc SamplerParameterf;
     glSamplerParameterfvProc SamplerParameterfv;
     glVertexAttribDivisorProc VertexAttribDivisor;
+    glQueryCounterProc QueryCounter;
+    glGetQueryObjectui64vProc GetQueryObjectui64v;
+
+    // GL_VERSION_4_1
+    glGetProgramBinaryProc GetProgramBinary;
+    glProgramBinaryProc ProgramBinary;
+    glProgramParameteriProc ProgramParameteri;
+
+    // GL_VERSION_4_4
+    glBufferStorageProc BufferStorage;
+
+    // KHR_parallel_shader_compile
+    glMaxShaderCompilerThreadsProc MaxShaderCompilerThreads;
 };
 
 struct VertexFormat {
@@ -439,6 +606,21 @@ union ClearValue {
     unsigned int clear_uints[4];
 };
 
+struct NamedVertexFormat {
+    const char * name;
+    VertexFormat format;
+};
+
+struct NamedImageFormat {
+    const char * name;
+    ImageFormat format;
+};
+
+struct NamedEnum {
+    const char * name;
+    int value;
+};
+
 union IntPair {
     unsigned long long pair;
     struct {
@@ -447,92 +629,175 @@ union IntPair {
     };
 };
 
-VertexFormat get_vertex_format(const char * format) {
-    if (!strcmp(format, "uint8x2")) return {GL_UNSIGNED_BYTE, 2, false, true};
-    if (!strcmp(format, "uint8x4")) return {GL_UNSIGNED_BYTE, 4, false, true};
-    if (!strcmp(format, "sint8x2")) return {GL_BYTE, 2, false, true};
-    if (!strcmp(format, "sint8x4")) return {GL_BYTE, 4, false, true};
-    if (!strcmp(format, "unorm8x2")) return {GL_UNSIGNED_BYTE, 2, true, false};
-    if (!strcmp(format, "unorm8x4")) return {GL_UNSIGNED_BYTE, 4, true, false};
-    if (!strcmp(format, "snorm8x2")) return {GL_BYTE, 2, true, false};
-    if (!strcmp(format, "snorm8x4")) return {GL_BYTE, 4, true, false};
-    if (!strcmp(format, "uint16x2")) return {GL_UNSIGNED_SHORT, 2, false, true};
-    if (!strcmp(format, "uint16x4")) return {GL_UNSIGNED_SHORT, 4, false, true};
-    if (!strcmp(format, "sint16x2")) return {GL_SHORT, 2, false, true};
-    if (!strcmp(format, "sint16x4")) return {GL_SHORT, 4, false, true};
-    if (!strcmp(format, "unorm16x2")) return {GL_UNSIGNED_SHORT, 2, true, false};
-    if (!strcmp(format, "unorm16x4")) return {GL_UNSIGNED_SHORT, 4, true, false};
-    if (!strcmp(format, "snorm16x2")) return {GL_SHORT, 2, true, false};
-    if (!strcmp(format, "snorm16x4")) return {GL_SHORT, 4, true, false};
-    if (!strcmp(format, "float16x2")) return {GL_HALF_FLOAT, 2, false, false};
-    if (!strcmp(format, "float16x4")) return {GL_HALF_FLOAT, 4, false, false};
-    if (!strcmp(format, "float32")) return {GL_FLOAT, 1, false, false};
-    if (!strcmp(format, "float32x2")) return {GL_FLOAT, 2, false, false};
-    if (!strcmp(format, "float32x3")) return {GL_FLOAT, 3, false, false};
-    if (!strcmp(format, "float32x4")) return {GL_FLOAT, 4, false, false};
-    if (!strcmp(format, "uint32")) return {GL_UNSIGNED_INT, 1, false, true};
-    if (!strcmp(format, "uint32x2")) return {GL_UNSIGNED_INT, 2, false, true};
-    if (!strcmp(format, "uint32x3")) return {GL_UNSIGNED_INT, 3, false, true};
-    if (!strcmp(format, "uint32x4")) return {GL_UNSIGNED_INT, 4, false, true};
-    if (!strcmp(format, "sint32")) return {GL_INT, 1, false, true};
-    if (!strcmp(format, "sint32x2")) return {GL_INT, 2, false, true};
-    if (!strcmp(format, "sint32x3")) return {GL_INT, 3, false, true};
-    if (!strcmp(format, "sint32x4")) return {GL_INT, 4, false, true};
-    return {};
-}
+const NamedVertexFormat vertex_formats[] = {
+    {"uint8x2", {GL_UNSIGNED_BYTE, 2, false, true}},
+    {"uint8x4", {GL_UNSIGNED_BYTE, 4, false, true}},
+    {"sint8x2", {GL_BYTE, 2, false, true}},
+    {"sint8x4", {GL_BYTE, 4, false, true}},
+    {"unorm8x2", {GL_UNSIGNED_BYTE, 2, true, false}},
+    {"unorm8x4", {GL_UNSIGNED_BYTE, 4, true, false}},
+    {"snorm8x2", {GL_BYTE, 2, true, false}},
+    {"snorm8x4", {GL_BYTE, 4, true, false}},
+    {"uint16x2", {GL_UNSIGNED_SHORT, 2, false, true}},
+    {"uint16x4", {GL_UNSIGNED_SHORT, 4, false, true}},
+    {"sint16x2", {GL_SHORT, 2, false, true}},
+    {"sint16x4", {GL_SHORT, 4, false, true}},
+    {"unorm16x2", {GL_UNSIGNED_SHORT, 2, true, false}},
+    {"unorm16x4", {GL_UNSIGNED_SHORT, 4, true, false}},
+    {"snorm16x2", {GL_SHORT, 2, true, false}},
+    {"snorm16x4", {GL_SHORT, 4, true, false}},
+    {"float16x2", {GL_HALF_FLOAT, 2, false, false}},
+    {"float16x4", {GL_HALF_FLOAT, 4, false, false}},
+    {"float32", {GL_FLOAT, 1, false, false}},
+    {"float32x2", {GL_FLOAT, 2, false, false}},
+    {"float32x3", {GL_FLOAT, 3, false, false}},
+    {"float32x4", {GL_FLOAT, 4, false, false}},
+    {"uint32", {GL_UNSIGNED_INT, 1, false, true}},
+    {"uint32x2", {GL_UNSIGNED_INT, 2, false, true}},
+    {"uint32x3", {GL_UNSIGNED_INT, 3, false, true}},
+    {"uint32x4", {GL_UNSIGNED_INT, 4, false, true}},
+    {"sint32", {GL_INT, 1, false, true}},
+    {"sint32x2", {GL_INT, 2, false, true}},
+    {"sint32x3", {GL_INT, 3, false, true}},
+    {"sint32x4", {GL_INT, 4, false, true}},
+};
 
-ImageFormat get_image_format(const char * format) {
-    if (!strcmp(format, "r8unorm")) return {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1, 1, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "rg8unorm")) return {GL_RG8, GL_RG, GL_UNSIGNED_BYTE, 2, 2, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "rgba8unorm")) return {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, 4, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "bgra8unorm")) return {GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE, 4, 4, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "r8snorm")) return {GL_R8_SNORM, GL_RED, GL_UNSIGNED_BYTE, 1, 1, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "rg8snorm")) return {GL_RG8_SNORM, GL_RG, GL_UNSIGNED_BYTE, 2, 2, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "rgba8snorm")) return {GL_RGBA8_SNORM, GL_RGBA, GL_UNSIGNED_BYTE, 4, 4, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "r8uint")) return {GL_R8UI, GL_RED, GL_UNSIGNED_BYTE, 1, 1, GL_COLOR, true, 'u'};
-    if (!strcmp(format, "rg8uint")) return {GL_RG8UI, GL_RG, GL_UNSIGNED_BYTE, 2, 2, GL_COLOR, true, 'u'};
-    if (!strcmp(format, "rgba8uint")) return {GL_RGBA8UI, GL_RGBA, GL_UNSIGNED_BYTE, 4, 4, GL_COLOR, true, 'u'};
-    if (!strcmp(format, "r16uint")) return {GL_R16UI, GL_RED, GL_UNSIGNED_SHORT, 1, 2, GL_COLOR, true, 'u'};
-    if (!strcmp(format, "rg16uint")) return {GL_RG16UI, GL_RG, GL_UNSIGNED_SHORT, 2, 4, GL_COLOR, true, 'u'};
-    if (!strcmp(format, "rgba16uint")) return {GL_RGBA16UI, GL_RGBA, GL_UNSIGNED_SHORT, 4, 8, GL_COLOR, true, 'u'};
-    if (!strcmp(format, "r32uint")) return {GL_R32UI, GL_RED, GL_UNSIGNED_INT, 1, 4, GL_COLOR, true, 'u'};
-    if (!strcmp(format, "rg32uint")) return {GL_RG32UI, GL_RG, GL_UNSIGNED_INT, 2, 8, GL_COLOR, true, 'u'};
-    if (!strcmp(format, "rgba32uint")) return {GL_RGBA32UI, GL_RGBA, GL_UNSIGNED_INT, 4, 16, GL_COLOR, true, 'u'};
-    if (!strcmp(format, "r8sint")) return {GL_R8I, GL_RED, GL_BYTE, 1, 1, GL_COLOR, true, 'i'};
-    if (!strcmp(format, "rg8sint")) return {GL_RG8I, GL_RG, GL_BYTE, 2, 2, GL_COLOR, true, 'i'};
-    if (!strcmp(format, "rgba8sint")) return {GL_RGBA8I, GL_RGBA, GL_BYTE, 4, 4, GL_COLOR, true, 'i'};
-    if (!strcmp(format, "r16sint")) return {GL_R16I, GL_RED, GL_SHORT, 1, 2, GL_COLOR, true, 'i'};
-    if (!strcmp(format, "rg16sint")) return {GL_RG16I, GL_RG, GL_SHORT, 2, 4, GL_COLOR, true, 'i'};
-    if (!strcmp(format, "rgba16sint")) return {GL_RGBA16I, GL_RGBA, GL_SHORT, 4, 8, GL_COLOR, true, 'i'};
-    if (!strcmp(format, "r32sint")) return {GL_R32I, GL_RED, GL_INT, 1, 4, GL_COLOR, true, 'i'};
-    if (!strcmp(format, "rg32sint")) return {GL_RG32I, GL_RG, GL_INT, 2, 8, GL_COLOR, true, 'i'};
-    if (!strcmp(format, "rgba32sint")) return {GL_RGBA32I, GL_RGBA, GL_INT, 4, 16, GL_COLOR, true, 'i'};
-    if (!strcmp(format, "r16float")) return {GL_R16F, GL_RED, GL_FLOAT, 1, 2, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "rg16float")) return {GL_RG16F, GL_RG, GL_FLOAT, 2, 4, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "rgba16float")) return {GL_RGBA16F, GL_RGBA, GL_FLOAT, 4, 8, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "r32float")) return {GL_R32F, GL_RED, GL_FLOAT, 1, 4, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "rg32float")) return {GL_RG32F, GL_RG, GL_FLOAT, 2, 8, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "rgba32float")) return {GL_RGBA32F, GL_RGBA, GL_FLOAT, 4, 16, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "rgba8unorm-srgb")) return {GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, 4, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "bgra8unorm-srgb")) return {GL_SRGB8_ALPHA8, GL_BGRA, GL_UNSIGNED_BYTE, 4, 4, GL_COLOR, true, 'f'};
-    if (!strcmp(format, "stencil8")) return {GL_STENCIL_INDEX8, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, 1, 1, GL_STENCIL, false, 'i'};
-    if (!strcmp(format, "depth16unorm")) return {GL_DEPTH_COMPONENT16, GL_DEPTH_COMPONENT, GL_FLOAT, 1, 2, GL_DEPTH, false, 'f'};
-    if (!strcmp(format, "depth24plus")) return {GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT, 1, 4, GL_DEPTH, false, 'f'};
-    if (!strcmp(format, "depth24plus-stencil8")) return {GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_FLOAT, 2, 4, GL_DEPTH_STENCIL, false, 'x'};
-    if (!strcmp(format, "depth32float")) return {GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT, 1, 4, GL_DEPTH, false, 'f'};
-    return {};
-}
+const NamedImageFormat image_formats[] = {
+    {"r8unorm", {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1, 1, GL_COLOR, true, 'f'}},
+    {"rg8unorm", {GL_RG8, GL_RG, GL_UNSIGNED_BYTE, 2, 2, GL_COLOR, true, 'f'}},
+    {"rgba8unorm", {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, 4, GL_COLOR, true, 'f'}},
+    {"bgra8unorm", {GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE, 4, 4, GL_COLOR, true, 'f'}},
+    {"r8snorm", {GL_R8_SNORM, GL_RED, GL_UNSIGNED_BYTE, 1, 1, GL_COLOR, true, 'f'}},
+    {"rg8snorm", {GL_RG8_SNORM, GL_RG, GL_UNSIGNED_BYTE, 2, 2, GL_COLOR, true, 'f'}},
+    {"rgba8snorm", {GL_RGBA8_SNORM, GL_RGBA, GL_UNSIGNED_BYTE, 4, 4, GL_COLOR, true, 'f'}},
+    {"r8uint", {GL_R8UI, GL_RED, GL_UNSIGNED_BYTE, 1, 1, GL_COLOR, true, 'u'}},
+    {"rg8uint", {GL_RG8UI, GL_RG, GL_UNSIGNED_BYTE, 2, 2, GL_COLOR, true, 'u'}},
+    {"rgba8uint", {GL_RGBA8UI, GL_RGBA, GL_UNSIGNED_BYTE, 4, 4, GL_COLOR, true, 'u'}},
+    {"r16uint", {GL_R16UI, GL_RED, GL_UNSIGNED_SHORT, 1, 2, GL_COLOR, true, 'u'}},
+    {"rg16uint", {GL_RG16UI, GL_RG, GL_UNSIGNED_SHORT, 2, 4, GL_COLOR, true, 'u'}},
+    {"rgba16uint", {GL_RGBA16UI, GL_RGBA, GL_UNSIGNED_SHORT, 4, 8, GL_COLOR, true, 'u'}},
+    {"r32uint", {GL_R32UI, GL_RED, GL_UNSIGNED_INT, 1, 4, GL_COLOR, true, 'u'}},
+    {"rg32uint", {GL_RG32UI, GL_RG, GL_UNSIGNED_INT, 2, 8, GL_COLOR, true, 'u'}},
+    {"rgba32uint", {GL_RGBA32UI, GL_RGBA, GL_UNSIGNED_INT, 4, 16, GL_COLOR, true, 'u'}},
+    {"r8sint", {GL_R8I, GL_RED, GL_BYTE, 1, 1, GL_COLOR, true, 'i'}},
+    {"rg8sint", {GL_RG8I, GL_RG, GL_BYTE, 2, 2, GL_COLOR, true, 'i'}},
+    {"rgba8sint", {GL_RGBA8I, GL_RGBA, GL_BYTE, 4, 4, GL_COLOR, true, 'i'}},
+    {"r16sint", {GL_R16I, GL_RED, GL_SHORT, 1, 2, GL_COLOR, true, 'i'}},
+    {"rg16sint", {GL_RG16I, GL_RG, GL_SHORT, 2, 4, GL_COLOR, true, 'i'}},
+    {"rgba16sint", {GL_RGBA16I, GL_RGBA, GL_SHORT, 4, 8, GL_COLOR, true, 'i'}},
+    {"r32sint", {GL_R32I, GL_RED, GL_INT, 1, 4, GL_COLOR, true, 'i'}},
+    {"rg32sint", {GL_RG32I, GL_RG, GL_INT, 2, 8, GL_COLOR, true, 'i'}},
+    {"rgba32sint", {GL_RGBA32I, GL_RGBA, GL_INT, 4, 16, GL_COLOR, true, 'i'}},
+    {"r16float", {GL_R16F, GL_RED, GL_FLOAT, 1, 2, GL_COLOR, true, 'f'}},
+    {"rg16float", {GL_RG16F, GL_RG, GL_FLOAT, 2, 4, GL_COLOR, true, 'f'}},
+    {"rgba16float", {GL_RGBA16F, GL_RGBA, GL_FLOAT, 4, 8, GL_COLOR, true, 'f'}},
+    {"r32float", {GL_R32F, GL_RED, GL_FLOAT, 1, 4, GL_COLOR, true, 'f'}},
+    {"rg32float", {GL_RG32F, GL_RG, GL_FLOAT, 2, 8, GL_COLOR, true, 'f'}},
+    {"rgba32float", {GL_RGBA32F, GL_RGBA, GL_FLOAT, 4, 16, GL_COLOR, true, 'f'}},
+    {"rgba8unorm-srgb", {GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, 4, GL_COLOR, true, 'f'}},
+    {"bgra8unorm-srgb", {GL_SRGB8_ALPHA8, GL_BGRA, GL_UNSIGNED_BYTE, 4, 4, GL_COLOR, true, 'f'}},
+    {"stencil8", {GL_STENCIL_INDEX8, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, 1, 1, GL_STENCIL, false, 'i'}},
+    {"depth16unorm", {GL_DEPTH_COMPONENT16, GL_DEPTH_COMPONENT, GL_FLOAT, 1, 2, GL_DEPTH, false, 'f'}},
+    {"depth24plus", {GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT, 1, 4, GL_DEPTH, false, 'f'}},
+    {"depth24plus-stencil8", {GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_FLOAT, 2, 4, GL_DEPTH_STENCIL, false, 'x'}},
+    {"depth32float", {GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT, 1, 4, GL_DEPTH, false, 'f'}},
+};
 
-int get_topology(const char * topology) {
-    if (!strcmp(topology, "points")) return GL_POINTS;
-    if (!strcmp(topology, "lines")) return GL_LINES;
-    if (!strcmp(topology, "line_loop")) return GL_LINE_LOOP;
-    if (!strcmp(topology, "line_strip")) return GL_LINE_STRIP;
-    if (!strcmp(topology, "triangles")) return GL_TRIANGLES;
-    if (!strcmp(topology, "triangle_strip")) return GL_TRIANGLE_STRIP;
-    if (!strcmp(topology, "triangle_fan")) return GL_TRIANGLE_FAN;
-    return -1;
-}
+const NamedEnum topologies[] = {
+    {"points", GL_POINTS},
+    {"lines", GL_LINES},
+    {"line_loop", GL_LINE_LOOP},
+    {"line_strip", GL_LINE_STRIP},
+    {"triangles", GL_TRIANGLES},
+    {"triangle_strip", GL_TRIANGLE_STRIP},
+    {"triangle_fan", GL_TRIANGLE_FAN},
+};
+
+const NamedEnum front_faces[] = {
+    {"cw", GL_CW},
+    {"ccw", GL_CCW},
+};
+
+const NamedEnum cull_faces[] = {
+    {"front", GL_FRONT},
+    {"back", GL_BACK},
+    {"front_and_back", GL_FRONT_AND_BACK},
+    {"none", 0},
+};
+
+const NamedEnum min_filters[] = {
+    {"nearest", GL_NEAREST},
+    {"linear", GL_LINEAR},
+    {"nearest_mipmap_nearest", GL_NEAREST_MIPMAP_NEAREST},
+    {"linear_mipmap_nearest", GL_LINEAR_MIPMAP_NEAREST},
+    {"nearest_mipmap_linear", GL_NEAREST_MIPMAP_LINEAR},
+    {"linear_mipmap_linear", GL_LINEAR_MIPMAP_LINEAR},
+};
+
+const NamedEnum mag_filters[] = {
+    {"nearest", GL_NEAREST},
+    {"linear", GL_LINEAR},
+};
+
+const NamedEnum texture_wraps[] = {
+    {"repeat", GL_REPEAT},
+    {"clamp_to_edge", GL_CLAMP_TO_EDGE},
+    {"mirrored_repeat", GL_MIRRORED_REPEAT},
+};
+
+const NamedEnum compare_modes[] = {
+    {"ref_to_texture", GL_COMPARE_REF_TO_TEXTURE},
+    {"none", 0},
+};
+
+const NamedEnum compare_funcs[] = {
+    {"never", GL_NEVER},
+    {"less", GL_LESS},
+    {"equal", GL_EQUAL},
+    {"lequal", GL_LEQUAL},
+    {"greater", GL_GREATER},
+    {"notequal", GL_NOTEQUAL},
+    {"gequal", GL_GEQUAL},
+    {"always", GL_ALWAYS},
+};
+
+const NamedEnum blend_constants[] = {
+    {"zero", GL_ZERO},
+    {"one", GL_ONE},
+    {"src_color", GL_SRC_COLOR},
+    {"one_minus_src_color", GL_ONE_MINUS_SRC_COLOR},
+    {"src_alpha", GL_SRC_ALPHA},
+    {"one_minus_src_alpha", GL_ONE_MINUS_SRC_ALPHA},
+    {"dst_alpha", GL_DST_ALPHA},
+    {"one_minus_dst_alpha", GL_ONE_MINUS_DST_ALPHA},
+    {"dst_color", GL_DST_COLOR},
+    {"one_minus_dst_color", GL_ONE_MINUS_DST_COLOR},
+    {"src_alpha_saturate", GL_SRC_ALPHA_SATURATE},
+    {"constant_color", GL_CONSTANT_COLOR},
+    {"one_minus_constant_color", GL_ONE_MINUS_CONSTANT_COLOR},
+    {"constant_alpha", GL_CONSTANT_ALPHA},
+    {"one_minus_constant_alpha", GL_ONE_MINUS_CONSTANT_ALPHA},
+    {"src1_alpha", GL_SRC1_ALPHA},
+    {"src1_color", GL_SRC1_COLOR},
+    {"one_minus_src1_color", GL_ONE_MINUS_SRC1_COLOR},
+    {"one_minus_src1_alpha", GL_ONE_MINUS_SRC1_ALPHA},
+};
+
+const NamedEnum stencil_ops[] = {
+    {"zero", GL_ZERO},
+    {"keep", GL_KEEP},
+    {"replace", GL_REPLACE},
+    {"incr", GL_INCR},
+    {"decr", GL_DECR},
+    {"invert", GL_INVERT},
+    {"incr_wrap", GL_INCR_WRAP},
+    {"decr_wrap", GL_DECR_WRAP},
+};
+
+const NamedEnum vertex_steps[] = {
+    {"vertex", 0},
+    {"instance", 1},
+};
 
 int count_mipmaps(int width, int height) {
     int size = width > height ? width : height;
@@ -544,15 +809,21 @@ int count_mipmaps(int width, int height) {
     return 32;
 }
 
-void remove_dict_value(PyObject * dict, PyObject * obj) {
-    PyObject * key = NULL;
-    PyObject * value = NULL;
-    Py_ssize_t pos = 0;
-    while (PyDict_Next(dict, &pos, &key, &value)) {
-        if (value == obj) {
-            PyDict_DelItem(dict, key);
-            break;
-        }
+long long image_memory(int width, int height, int layers, int pixel_size, int levels) {
+    long long res = 0;
+    for (int i = 0; i < levels; ++i) {
+        const long long level_width = width >> i > 1 ? width >> i : 1;
+        const long long level_height = height >> i > 1 ? height >> i : 1;
+        res += level_width * level_height * layers * pixel_size;
+    }
+    return res;
+}
+
+void remove_dict_key(PyObject * dict, PyObject ** key) {
+    if (PyObject * tmp = *key) {
+        *key = NULL;
+        PyDict_DelItem(dict, tmp);
+        Py_DECREF(tmp);
     }
 }
 
@@ -627,6 +898,7 @@ GLMethods load_gl(PyObject * context) {
     load(Enable);
     load(DepthFunc);
     load(ReadBuffer);
+    load(PixelStorei);
     load(ReadPixels);
     load(GetError);
     load(GetIntegerv);
@@ -636,6 +908,7 @@ GLMethods load_gl(PyObject * context) {
     // GL_VERSION_1_1
     load(PolygonOffset);
     load(TexSubImage2D);
+    load(CopyTexSubImage2D);
     load(BindTexture);
     load(DeleteTextures);
     load(GenTextures);
@@ -643,12 +916,15 @@ GLMethods load_gl(PyObject * context) {
     // GL_VERSION_1_2
     load(TexImage3D);
     load(TexSubImage3D);
+    load(CopyTexSubImage3D);
 
     // GL_VERSION_1_3
     load(ActiveTexture);
 
     // GL_VERSION_1_4
     load(BlendFuncSeparate);
+    load(MultiDrawArrays);
+    load(MultiDrawElements);
 
     // GL_VERSION_1_5
     load(BindBuffer);
@@ -657,6 +933,11 @@ GLMethods load_gl(PyObject * context) {
     load(BufferData);
     load(BufferSubData);
     load(UnmapBuffer);
+    load(GenQueries);
+    load(DeleteQueries);
+    load(BeginQuery);
+    load(EndQuery);
+    load(GetQueryObjectiv);
 
     // GL_VERSION_2_0
     load(DrawBuffers);
@@ -703,9 +984,13 @@ GLMethods load_gl(PyObject * context) {
     load(FramebufferTexture2D);
     load(FramebufferRenderbuffer);
     load(GenerateMipmap);
+    load(FramebufferTextureLayer);
     load(BlitFramebuffer);
     load(RenderbufferStorageMultisample);
     load(MapBufferRange);
+    load(GetStringi);
+    load(BeginConditionalRender);
+    load(EndConditionalRender);
     load(BindVertexArray);
     load(DeleteVertexArrays);
     load(GenVertexArrays);
@@ -714,11 +999,20 @@ GLMethods load_gl(PyObject * context) {
     load(DrawArraysInstanced);
     load(DrawElementsInstanced);
     load(PrimitiveRestartIndex);
+    load(CopyBufferSubData);
     load(GetUniformBlockIndex);
     load(GetActiveUniformBlockiv);
     load(GetActiveUniformBlockName);
     load(UniformBlockBinding);
 
+    // GL_VERSION_3_2
+    load(DrawElementsInstancedBaseVertex);
+    load(MultiDrawElementsBaseVertex);
+    load(FenceSync);
+    load(DeleteSync);
+    load(ClientWaitSync);
+    load(WaitSync);
+
     // GL_VERSION_3_3
     load(GenSamplers);
     load(DeleteSamplers);
@@ -727,6 +1021,28 @@ GLMethods load_gl(PyObject * context) {
     load(SamplerParameterf);
     load(SamplerParameterfv);
     load(VertexAttribDivisor);
+    load(QueryCounter);
+    load(GetQueryObjectui64v);
+
+    // GL_VERSION_4_1 or ARB_get_program_binary, optional
+    res.GetProgramBinary = (glGetProgramBinaryProc)load_method(context, "glGetProgramBinary");
+    PyErr_Clear();
+    res.ProgramBinary = (glProgramBinaryProc)load_method(context, "glProgramBinary");
+    PyErr_Clear();
+    res.ProgramParameteri = (glProgramParameteriProc)load_method(context, "glProgramParameteri");
+    PyErr_Clear();
+
+    // GL_VERSION_4_4 or ARB_buffer_storage, optional
+    res.BufferStorage = (glBufferStorageProc)load_method(context, "glBufferStorage");
+    PyErr_Clear();
+
+    // KHR_parallel_shader_compile or ARB_parallel_shader_compile, optional
+    res.MaxShaderCompilerThreads = (glMaxShaderCompilerThreadsProc)load_method(context, "glMaxShaderCompilerThreadsKHR");
+    PyErr_Clear();
+    if (!res.MaxShaderCompilerThreads) {
+        res.MaxShaderCompilerThreads = (glMaxShaderCompilerThreadsProc)load_method(context, "glMaxShaderCompilerThreadsARB");
+        PyErr_Clear();
+    }
 
     #undef load
     #undef check
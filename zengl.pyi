@@ -1,4 +1,5 @@
-from typing import Any, Dict, Iterable, List, Literal, Tuple, TypedDict
+from os import PathLike
+from typing import Any, Callable, Dict, Iterable, List, Literal, Tuple, TypedDict
 
 FrontFace = Literal['cw', 'ccw']
 CullFace = Literal['front', 'back', 'front_and_back', 'none']
@@ -137,6 +138,49 @@ class Buffer:
     def write(self, data: Bytes, offset: int = 0) -> None: ...
     def map(self, size: int | None = None, *, offset: int | None = None, discard: bool = False) -> memoryview: ...
     def unmap(self) -> None: ...
+    def copy_to(self, other: 'Buffer', src_offset: int = 0, dst_offset: int = 0, size: int | None = None) -> None: ...
+
+
+class BufferSlice:
+    buffer: Buffer
+    offset: int
+    size: int
+
+
+class BufferPool:
+    buffer: Buffer
+    used: int
+    def alloc(self, size: int, alignment: int = 4) -> BufferSlice: ...
+    def free(self, slice: BufferSlice) -> None: ...
+
+
+class RingBuffer:
+    buffer: Buffer
+    size: int
+    frames: int
+    frame: int
+    used: int
+    def write(self, data: Bytes) -> int: ...
+    def next_frame(self) -> None: ...
+
+
+class AsyncRead:
+    def ready(self) -> bool: ...
+    def wait(self, timeout: float | None = None) -> bool: ...
+    def result(self) -> bytes: ...
+
+
+class Query:
+    kind: str
+    def begin(self) -> None: ...
+    def end(self) -> None: ...
+    def result(self, wait: bool = True) -> int | None: ...
+
+
+class Fence:
+    signaled: bool
+    def client_wait(self, timeout: float | None = None) -> bool: ...
+    def wait(self) -> None: ...
 
 
 class Image:
@@ -147,25 +191,62 @@ class Image:
     def clear(self) -> None: ...
     def write(
         self, data: Bytes, size: Tuple[int, int] | None = None,
-        offset: Tuple[int, int] | None = None, layer: int | None = None) -> None: ...
+        offset: Tuple[int, int] | None = None, layer: int | None = None, async_: bool = False) -> None: ...
+    def map(
+        self, size: Tuple[int, int] | None = None, *,
+        offset: Tuple[int, int] | None = None, layer: int | None = None) -> memoryview: ...
+    def unmap(self) -> None: ...
     def mipmaps(self, *, base: int = 0, levels: int | None = None) -> None: ...
     def read(self, size: Tuple[int, int] | None = None, *, offset: Tuple[int, int] | None = None) -> bytes: ...
+    def read_into(
+        self, dest: Any, size: Tuple[int, int] | None = None, *, offset: Tuple[int, int] | None = None,
+        layer: int | None = None, level: int = 0, stride: int | None = None) -> None: ...
+    def write_from_buffer(
+        self, buffer: Buffer, buffer_offset: int = 0, size: Tuple[int, int] | None = None, *,
+        offset: Tuple[int, int] | None = None, layer: int | None = None) -> None: ...
+    def read_to_buffer(
+        self, buffer: Buffer, buffer_offset: int = 0, size: Tuple[int, int] | None = None, *,
+        offset: Tuple[int, int] | None = None, layer: int | None = None, level: int = 0) -> None: ...
+    def read_async(self, size: Tuple[int, int] | None = None, *, offset: Tuple[int, int] | None = None) -> AsyncRead: ...
     def blit(
         self, target: 'Image' | None = None, target_viewport: Viewport | None = None, *,
         source_viewport: Viewport | None = None, filter: bool = True, srgb: bool = False) -> None: ...
+    def copy(
+        self, target: 'Image', size: Tuple[int, int] | None = None, *, offset: Tuple[int, int] | None = None,
+        target_offset: Tuple[int, int] | None = None, layer: int | None = None, target_layer: int | None = None,
+        level: int = 0, target_level: int = 0) -> None: ...
 
 
 class Pipeline:
     vertex_count: int
     instance_count: int
     first_vertex: int
+    base_vertex: int
+    layer: int
     viewport: Viewport
-    def render(self) -> None: ...
+    gpu_time: int
+    gpu_time_count: int
+    def render(self, *, profile: bool = False, condition: Query | None = None) -> None: ...
+    def render_occlusion(self, queries: Iterable[Query], *, ranges: Bytes | None = None) -> None: ...
+    def render_ranges(self, ranges: Bytes, *, base_vertex: bool = False) -> None: ...
+
+
+class CommandList:
+    count: int
+    def render(self, pipeline: Pipeline) -> None: ...
+    def viewport(self, pipeline: Pipeline, viewport: Viewport) -> None: ...
+    def clear(self, image: Image) -> None: ...
+    def blit(
+        self, image: Image, target: Image | None = None, target_viewport: Viewport | None = None,
+        source_viewport: Viewport | None = None, filter: bool = True, srgb: bool = False) -> None: ...
+    def write(self, buffer: Buffer, data: Bytes, offset: int = 0) -> None: ...
 
 
 class Context:
     info: Tuple[str, str, str]
     includes: Dict[str, str]
+    memory_budget: int | None
+    memory_hook: Callable[[str, int], Any] | None
     def buffer(self, data: Bytes | None = None, *, size: int | None = None, dynamic: bool = False) -> Buffer: ...
     def image(
         self, size: Tuple[int, int], format: ImageFormat, data: Bytes | None = None, *,
@@ -192,13 +273,34 @@ class Context:
         vertex_count: int = 0,
         instance_count: int = 0,
         first_vertex: int = 0,
+        base_vertex: int = 0,
         line_width: float = 1.0,
-        viewport: Viewport | None = None) -> Pipeline: ...
+        viewport: Viewport | None = None,
+        layer: int = 0) -> Pipeline: ...
+    def pipelines(self, pipelines: Iterable[Dict[str, Any]]) -> List[Pipeline]: ...
     def clear_shader_cache(self) -> None: ...
-    def release(self, obj: Buffer | Image | Pipeline) -> None: ...
-
-
-def context(loader: ContextLoader | Any | None = None) -> Context: ...
+    def release(self, obj: Buffer | BufferPool | Image | Pipeline | Query | Fence | RingBuffer) -> None: ...
+    def release_many(self, objs: Iterable[Buffer | BufferPool | Image | Pipeline | Query | Fence | RingBuffer]) -> None: ...
+    def render(self, pipelines: Iterable[Pipeline], *, sort: bool = False) -> None: ...
+    def invalidate_state(self) -> None: ...
+    def buffer_pool(self, size: int, *, dynamic: bool = True) -> BufferPool: ...
+    def ring_buffer(self, size: int, *, frames: int = 3) -> RingBuffer: ...
+    def end_frame(self) -> None: ...
+    def stats(self) -> Dict[str, Any]: ...
+    def reset_stats(self) -> None: ...
+    def memory(self) -> Dict[str, int]: ...
+    def transient_image(
+        self, size: Tuple[int, int], format: ImageFormat, *, samples: int = 1, texture: bool | None = None) -> Image: ...
+    def clear_transient_images(self) -> None: ...
+    def query(
+        self, kind: Literal['time_elapsed', 'timestamp', 'primitives_generated', 'samples_passed', 'any_samples_passed'],
+    ) -> Query: ...
+    def command_list(self) -> CommandList: ...
+    def execute(self, commands: CommandList) -> None: ...
+    def fence(self) -> Fence: ...
+
+
+def context(loader: ContextLoader | Any | None = None, *, program_cache: str | PathLike | None = None) -> Context: ...
 def camera(
     eye: Vec3, target: Vec3, up: Vec3 = (0.0, 0.0, 1.0), *,
     fov: float = 45.0, aspect: float = 1.0, near: float = 0.1, far: float = 1000.0,